@@ -5,5 +5,32 @@ setlocal
 if not exist build mkdir build
 
 set CFLAGS=-std=c99 -O0 -g -Wall -Wextra
+set SAMPLES=tests/0.txt tests/sample.txt
 
 clang %CFLAGS% -o build\compiler.exe code\*.c -luser32.lib || exit /b 1
+
+rem each case's output, less the times, must be what's expected
+if exist build\tests rmdir /s /q build\tests
+mkdir build\tests
+set FAILURES=0
+for /f "usebackq tokens=1,*" %%a in ("tests\cases.txt") do (
+	if exist tests\requests\%%a.txt (
+		build\compiler.exe %%b < tests\requests\%%a.txt 2>&1 | findstr /v /r /c:" ms$" > build\tests\%%a.txt
+	) else (
+		build\compiler.exe %%b < nul 2>&1 | findstr /v /r /c:" ms$" > build\tests\%%a.txt
+	)
+	fc build\tests\%%a.txt tests\expected\%%a.txt > nul || (
+		echo %%a: the output isn't what's expected, see build\tests\%%a.txt
+		set /a FAILURES+=1
+	)
+	if exist tests\expected\%%a.o fc /b build\tests\%%a.o tests\expected\%%a.o > nul || (
+		echo %%a: the object isn't what's expected, see build\tests\%%a.o
+		set /a FAILURES+=1
+	)
+)
+if not %FAILURES%==0 (
+	echo %FAILURES% tests failed
+	exit /b 1
+)
+
+build\compiler.exe --gate tests/baselines.txt --machine-baselines build/baselines.txt %SAMPLES% || exit /b 1
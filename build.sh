@@ -0,0 +1,30 @@
+#!/bin/sh
+cd "$(dirname "$0")" || exit 1
+
+mkdir -p build
+
+CC=${CC:-clang}
+CFLAGS="-std=c99 -O0 -g -Wall -Wextra"
+SAMPLES="tests/0.txt tests/sample.txt"
+
+$CC $CFLAGS -o build/compiler code/*.c -lpthread || exit 1
+
+# each case's output, less the times, must be what's expected, on a stack that's as small as a thread's on Windows
+rm -rf build/tests
+mkdir -p build/tests
+failures=0
+while read -r name arguments; do
+	requests=tests/requests/$name.txt
+	[ -f "$requests" ] || requests=/dev/null
+	(ulimit -s 1024; build/compiler $arguments < "$requests") 2>&1 | grep -v " ms$" > "build/tests/$name.txt"
+	if ! cmp -s "build/tests/$name.txt" "tests/expected/$name.txt"; then
+		echo "$name: the output isn't what's expected, see build/tests/$name.txt"
+		failures=$((failures + 1))
+	elif [ -f "tests/expected/$name.o" ] && ! cmp -s "build/tests/$name.o" "tests/expected/$name.o"; then
+		echo "$name: the object isn't what's expected, see build/tests/$name.o"
+		failures=$((failures + 1))
+	fi
+done < tests/cases.txt
+[ $failures -eq 0 ] || { echo "$failures tests failed"; exit 1; }
+
+build/compiler --gate tests/baselines.txt --machine-baselines build/baselines.txt $SAMPLES || exit 1
@@ -0,0 +1,523 @@
+#if defined(__linux__)
+
+#include "compiler.h"
+
+extern S32   open          (const CHAR *, S32, ...);
+extern S32   close         (S32);
+extern S64   read          (S32, VOID *, SIZE);
+extern S64   write         (S32, const VOID *, SIZE);
+extern S64   lseek         (S32, S64, S32);
+extern S64   sysconf       (S32);
+extern S32   clock_gettime (S32, S64 *);
+extern VOID *mmap          (VOID *, SIZE, S32, S32, S32, S64);
+extern S32   munmap        (VOID *, SIZE);
+extern S32   mprotect      (VOID *, SIZE, S32);
+extern S32   madvise       (VOID *, SIZE, S32);
+extern S32   pthread_create(SIZE *, const VOID *, VOID *(*)(VOID *), VOID *);
+extern S32   pthread_join  (SIZE, VOID **);
+extern S32   sched_yield   (VOID);
+extern S64   syscall       (S64, ...);
+extern S32   statx         (S32, const CHAR *, S32, U32, VOID *);
+extern VOID *opendir       (const CHAR *);
+extern VOID *readdir       (VOID *);
+extern S32   closedir      (VOID *);
+extern S32   dirfd         (VOID *);
+
+HANDLE open_file(const CHAR *path)
+{
+	return open(path, 0);
+}
+
+HANDLE create_file(const CHAR *path)
+{
+	HANDLE file = open(path, 01 | 0100 | 01000, 0644);
+	assert(file != -1);
+	return file;
+}
+
+SIZE get_size_of_file(HANDLE file)
+{
+	S64 size = lseek(file, 0, 2);
+	assert(size != -1);
+	assert(lseek(file, 0, 0) == 0);
+	return size;
+}
+
+SIZE read_from_file(VOID *buffer, SIZE size, HANDLE file)
+{
+	S64 read_size = read(file, buffer, size);
+	assert(read_size != -1);
+	return read_size;
+}
+
+SIZE write_to_file(const VOID *buffer, SIZE size, HANDLE file)
+{
+	S64 written_size = write(file, buffer, size);
+	assert(written_size != -1);
+	return written_size;
+}
+
+VOID close_file(HANDLE file)
+{
+	assert(!close(file));
+}
+
+HANDLE get_standard_input(VOID)
+{
+	return 0;
+}
+
+HANDLE get_standard_output(VOID)
+{
+	return 1;
+}
+
+/* a `struct statx`'s mode is its fourteenth half-word, and its modification time is its fifteenth and sixteenth words */
+static enum FILE_KIND get_kind_of_file(const U64 status[32], U64 *modification_time)
+{
+	U16 mode = ((const U16 *)status)[14] & 0170000;
+	if (modification_time) *modification_time = status[14] * 1000000000 + (U32)status[15];
+	return mode == 0040000 ? FILE_KIND_directory : mode == 0100000 ? FILE_KIND_regular : FILE_KIND_other;
+}
+
+enum FILE_KIND query_file(const CHAR *path, U64 *modification_time)
+{
+	U64 status[32];
+	if (statx(-100, path, 0, 0x1 | 0x40, status)) return FILE_KIND_none;
+	return get_kind_of_file(status, modification_time);
+}
+
+/* a `struct dirent` */
+struct DIRECTORY_ENTRY {
+	U64 d_ino;
+	S64 d_off;
+	U16 d_reclen;
+	U8  d_type;
+	CHAR d_name[256];
+};
+
+BOOLEAN list_directory(const CHAR *path, DIRECTORY_VISITOR *visit, VOID *parameter)
+{
+	VOID *directory = opendir(path);
+	if (!directory) return 0;
+	for (const struct DIRECTORY_ENTRY *entry; (entry = readdir(directory));) {
+		const CHAR *name = entry->d_name;
+		if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2]))) continue;
+		enum FILE_KIND kind;
+		switch (entry->d_type) {
+		case 4:
+			kind = FILE_KIND_directory;
+			break;
+		case 8:
+			kind = FILE_KIND_regular;
+			break;
+		case 0:
+		case 10: {
+			/* the file system doesn't know, or it's a link, which is followed to a file only */
+			U64 status[32];
+			if (statx(dirfd(directory), name, entry->d_type ? 0 : 0x100, 0x1, status)) continue;
+			kind = get_kind_of_file(status, 0);
+			if (entry->d_type && kind == FILE_KIND_directory) kind = FILE_KIND_other;
+			break;
+		}
+		default:
+			kind = FILE_KIND_other;
+			break;
+		}
+		visit(name, kind, parameter);
+	}
+	assert(!closedir(directory));
+	return 1;
+}
+
+SIZE query_system_page_size(VOID)
+{
+	return sysconf(30);
+}
+
+SIZE query_processor_count(VOID)
+{
+	return sysconf(84);
+}
+
+SIZE query_performance_counter(VOID)
+{
+	S64 time[2];
+	assert(!clock_gettime(1, time));
+	return time[0] * 1000000000 + time[1];
+}
+
+SIZE query_performance_frequency(VOID)
+{
+	return 1000000000;
+}
+
+#if defined(__x86_64__)
+#define PERF_EVENT_OPEN 298
+#elif defined(__aarch64__)
+#define PERF_EVENT_OPEN 241
+#endif
+
+HANDLE open_event_counter(enum EVENT event)
+{
+#if defined(PERF_EVENT_OPEN)
+	/* a `struct perf_event_attr` for a hardware event that excludes the kernel and the hypervisor, which needn't be privileged */
+	U64 attributes[16] = { 0 };
+	attributes[0] = 0 | sizeof(attributes) << 32;
+	attributes[1] = event == EVENT_instructions ? 1 : 3;
+	attributes[5] = 1 << 5 | 1 << 6;
+	return syscall(PERF_EVENT_OPEN, attributes, 0, -1, -1, 0);
+#else
+	(VOID)event;
+	return -1;
+#endif
+}
+
+U64 read_event_counter(HANDLE counter)
+{
+	U64 count;
+	assert(read(counter, &count, sizeof(count)) == sizeof(count));
+	return count;
+}
+
+VOID close_event_counter(HANDLE counter)
+{
+	assert(!close(counter));
+}
+
+VOID *allocate_virtual_memory(SIZE size)
+{
+	VOID *result = mmap(0, size, 0x1 | 0x2, 0x02 | 0x20, -1, 0);
+	assert(result != (VOID *)-1);
+	return result;
+}
+
+VOID *reserve_virtual_memory(SIZE size)
+{
+	VOID *result = mmap(0, size, 0x0, 0x02 | 0x20 | 0x4000, -1, 0);
+	assert(result != (VOID *)-1);
+	return result;
+}
+
+VOID commit_virtual_memory(VOID *memory, SIZE size)
+{
+	assert(!mprotect(memory, size, 0x1 | 0x2));
+}
+
+VOID decommit_virtual_memory(VOID *memory, SIZE size)
+{
+	assert(!madvise(memory, size, 4));
+	assert(!mprotect(memory, size, 0x0));
+}
+
+VOID protect_virtual_memory(VOID *memory, SIZE size, BOOLEAN is_executable)
+{
+	assert(!mprotect(memory, size, is_executable ? 0x1 | 0x4 : 0x1 | 0x2));
+}
+
+VOID release_virtual_memory(VOID *memory, SIZE size)
+{
+	assert(!munmap(memory, size));
+}
+
+struct THREAD_START {
+	THREAD_PROCEDURE *procedure;
+	VOID *parameter;
+	BOOLEAN is_started;
+};
+
+static VOID *start_thread(VOID *parameter)
+{
+	struct THREAD_START start = *(struct THREAD_START *)parameter;
+	__atomic_store_n(&((struct THREAD_START *)parameter)->is_started, 1, __ATOMIC_RELEASE);
+	(VOID)start.procedure(start.parameter);
+	return 0;
+}
+
+HANDLE create_thread(THREAD_PROCEDURE *procedure, VOID *parameter)
+{
+	/* the start lives here, so it's waited on until the thread has copied it */
+	struct THREAD_START start = { .procedure = procedure, .parameter = parameter };
+	SIZE thread;
+	assert(!pthread_create(&thread, 0, start_thread, &start));
+	while (!__atomic_load_n(&start.is_started, __ATOMIC_ACQUIRE)) (VOID)sched_yield();
+	return thread;
+}
+
+VOID join_thread(HANDLE thread)
+{
+	assert(!pthread_join(thread, 0));
+}
+
+VOID yield_thread(VOID)
+{
+	(VOID)sched_yield();
+}
+
+/*
+NOTE(Emhyr): files are loaded with io_uring. every file's `openat` and `statx`
+are submitted together; once both are done, its data is allocated and its
+`read` is submitted, and once that's done, its `close`. the ring is only
+driven by whoever waits for a file, so there's no thread behind it.
+
+at most as many operations are in flight as there are submission entries, so
+the completion queue (which is twice as big) never overflows.
+*/
+
+enum RING_OPERATION {
+	RING_OPERATION_open,
+	RING_OPERATION_statx,
+	RING_OPERATION_read,
+	RING_OPERATION_close,
+};
+
+static const BYTE opcode_from_ring_operation[] = {
+	[RING_OPERATION_open ] = 18,
+	[RING_OPERATION_statx] = 21,
+	[RING_OPERATION_read ] = 22,
+	[RING_OPERATION_close] = 19,
+};
+
+struct RING_PARAMETERS {
+	U32 sq_entries;
+	U32 cq_entries;
+	U32 flags;
+	U32 sq_thread_cpu;
+	U32 sq_thread_idle;
+	U32 features;
+	U32 wq_fd;
+	U32 _reserved[3];
+	struct {
+		U32 head, tail, ring_mask, ring_entries, flags, dropped, array, _reserved;
+		U64 user_addr;
+	} sq_off;
+	struct {
+		U32 head, tail, ring_mask, ring_entries, overflow, cqes, flags, _reserved;
+		U64 user_addr;
+	} cq_off;
+};
+
+struct RING_SUBMISSION {
+	U8  opcode;
+	U8  flags;
+	U16 ioprio;
+	S32 fd;
+	U64 off;
+	U64 addr;
+	U32 len;
+	U32 op_flags;
+	U64 user_data;
+	U64 _padding[3];
+};
+
+struct RING_COMPLETION {
+	U64 user_data;
+	S32 res;
+	U32 flags;
+};
+
+struct RING_FILE {
+	U64 statx[32]; /* the size is the sixth */
+	const CHAR *path;
+	BYTE *data;
+	SIZE size; /* as it's mapped, less the padding */
+	SIZE read_size;
+	S32 file;
+	BYTE pending_count; /* of `openat` and `statx` */
+	BOOLEAN is_failed;
+	BOOLEAN is_done;
+	BOOLEAN is_taken;
+};
+
+struct RING_LOADER {
+	S32 ring;
+	U32 entries_count;
+	U32 in_flight_count;
+	U32 unsubmitted_count;
+	U32 *sq_head, *sq_tail, *sq_mask, *sq_array;
+	U32 *cq_head, *cq_tail, *cq_mask;
+	struct RING_SUBMISSION *submissions;
+	struct RING_COMPLETION *completions;
+	VOID *sq_ring, *cq_ring;
+	SIZE sq_ring_size, cq_ring_size;
+	SIZE padding_size;
+	SIZE memory_size;
+	SIZE files_count;
+	SIZE next_file; /* that isn't opened yet */
+	struct RING_FILE files[];
+};
+
+#define RING_ENTRIES_COUNT 256
+
+static VOID submit(enum RING_OPERATION operation, SIZE index, struct RING_LOADER *loader)
+{
+	struct RING_FILE *file = &loader->files[index];
+	U32 tail = *loader->sq_tail;
+	U32 i = tail & *loader->sq_mask;
+	struct RING_SUBMISSION *submission = &loader->submissions[i];
+	*submission = (struct RING_SUBMISSION){ .opcode = opcode_from_ring_operation[operation], .user_data = index << 2 | operation };
+	switch (operation) {
+	case RING_OPERATION_open:
+		submission->fd = -100;
+		submission->addr = (U64)file->path;
+		break;
+	case RING_OPERATION_statx:
+		submission->fd = -100;
+		submission->addr = (U64)file->path;
+		submission->len = 0x200;
+		submission->off = (U64)file->statx;
+		break;
+	case RING_OPERATION_read:
+		submission->fd = file->file;
+		submission->addr = (U64)(file->data + file->read_size);
+		submission->len = file->size - file->read_size < 0x40000000 ? file->size - file->read_size : 0x40000000;
+		submission->off = file->read_size;
+		break;
+	case RING_OPERATION_close:
+		submission->fd = file->file;
+		break;
+	}
+	loader->sq_array[i] = i;
+	__atomic_store_n(loader->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	++loader->in_flight_count;
+	++loader->unsubmitted_count;
+}
+
+static VOID finish(SIZE index, struct RING_LOADER *loader)
+{
+	struct RING_FILE *file = &loader->files[index];
+	if (file->is_failed && file->data) {
+		release_virtual_memory(file->data, file->size + loader->padding_size);
+		file->data = 0;
+	}
+	if (file->file >= 0) submit(RING_OPERATION_close, index, loader);
+	else file->is_done = 1;
+}
+
+static VOID complete(const struct RING_COMPLETION *completion, struct RING_LOADER *loader)
+{
+	--loader->in_flight_count;
+	SIZE index = completion->user_data >> 2;
+	struct RING_FILE *file = &loader->files[index];
+	switch ((enum RING_OPERATION)(completion->user_data & 3)) {
+	case RING_OPERATION_open:
+	case RING_OPERATION_statx:
+		if (completion->res < 0) file->is_failed = 1;
+		else if ((completion->user_data & 3) == RING_OPERATION_open) file->file = completion->res;
+		if (--file->pending_count) break;
+		if (file->is_failed) {
+			finish(index, loader);
+			break;
+		}
+		file->size = file->statx[5];
+		file->data = allocate_virtual_memory(file->size + loader->padding_size);
+		if (file->size) submit(RING_OPERATION_read, index, loader);
+		else finish(index, loader);
+		break;
+	case RING_OPERATION_read:
+		if (completion->res < 0) file->is_failed = 1;
+		else file->read_size += completion->res;
+		if (!file->is_failed && completion->res && file->read_size < file->size) {
+			submit(RING_OPERATION_read, index, loader);
+			break;
+		}
+		/* a file that shrank is read as far as it goes, and its mapping is cut to match, so that it's released like any other */
+		if (!file->is_failed && file->read_size < file->size) {
+			SIZE page_size = query_system_page_size();
+			SIZE kept_size = (file->read_size + loader->padding_size + page_size - 1) & ~(page_size - 1);
+			SIZE mapped_size = (file->size + loader->padding_size + page_size - 1) & ~(page_size - 1);
+			if (kept_size < mapped_size) release_virtual_memory(file->data + kept_size, mapped_size - kept_size);
+			file->size = file->read_size;
+		}
+		finish(index, loader);
+		break;
+	case RING_OPERATION_close:
+		file->file = -1;
+		file->is_done = 1;
+		break;
+	}
+}
+
+/* submits what it can, then reaps what's completed */
+static VOID drive(BOOLEAN is_waiting, struct RING_LOADER *loader)
+{
+	while (loader->next_file < loader->files_count && loader->in_flight_count + 2 <= loader->entries_count) {
+		struct RING_FILE *file = &loader->files[loader->next_file];
+		file->pending_count = 2;
+		submit(RING_OPERATION_open, loader->next_file, loader);
+		submit(RING_OPERATION_statx, loader->next_file, loader);
+		++loader->next_file;
+	}
+
+	/* it's retried on the next drive if it's interrupted */
+	S64 submitted_count = syscall(426, loader->ring, loader->unsubmitted_count, is_waiting && loader->in_flight_count, 1, 0, 0);
+	if (submitted_count > 0) loader->unsubmitted_count -= submitted_count;
+
+	U32 head = *loader->cq_head;
+	for (U32 tail = __atomic_load_n(loader->cq_tail, __ATOMIC_ACQUIRE); head != tail; ++head)
+		complete(&loader->completions[head & *loader->cq_mask], loader);
+	__atomic_store_n(loader->cq_head, head, __ATOMIC_RELEASE);
+}
+
+HANDLE begin_loading_files(const CHAR *const *paths, SIZE count, SIZE padding_size)
+{
+	struct RING_PARAMETERS parameters = { 0 };
+	S32 ring = syscall(425, RING_ENTRIES_COUNT, &parameters);
+	if (ring < 0) return 0;
+
+	SIZE memory_size = sizeof(struct RING_LOADER) + count * sizeof(struct RING_FILE);
+	struct RING_LOADER *loader = allocate_virtual_memory(memory_size);
+	loader->ring = ring;
+	loader->entries_count = parameters.sq_entries;
+	loader->padding_size = padding_size;
+	loader->memory_size = memory_size;
+	loader->files_count = count;
+	for (SIZE i = 0; i < count; ++i) {
+		loader->files[i].path = paths[i];
+		loader->files[i].file = -1;
+	}
+
+	loader->sq_ring_size = parameters.sq_off.array + parameters.sq_entries * sizeof(U32);
+	loader->cq_ring_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct RING_COMPLETION);
+	loader->sq_ring = mmap(0, loader->sq_ring_size, 0x1 | 0x2, 0x01 | 0x8000, ring, 0);
+	loader->cq_ring = mmap(0, loader->cq_ring_size, 0x1 | 0x2, 0x01 | 0x8000, ring, 0x8000000);
+	loader->submissions = mmap(0, parameters.sq_entries * sizeof(struct RING_SUBMISSION), 0x1 | 0x2, 0x01 | 0x8000, ring, 0x10000000);
+	assert(loader->sq_ring != (VOID *)-1 && loader->cq_ring != (VOID *)-1 && loader->submissions != (VOID *)-1);
+	loader->sq_head  = (U32 *)((BYTE *)loader->sq_ring + parameters.sq_off.head);
+	loader->sq_tail  = (U32 *)((BYTE *)loader->sq_ring + parameters.sq_off.tail);
+	loader->sq_mask  = (U32 *)((BYTE *)loader->sq_ring + parameters.sq_off.ring_mask);
+	loader->sq_array = (U32 *)((BYTE *)loader->sq_ring + parameters.sq_off.array);
+	loader->cq_head  = (U32 *)((BYTE *)loader->cq_ring + parameters.cq_off.head);
+	loader->cq_tail  = (U32 *)((BYTE *)loader->cq_ring + parameters.cq_off.tail);
+	loader->cq_mask  = (U32 *)((BYTE *)loader->cq_ring + parameters.cq_off.ring_mask);
+	loader->completions = (struct RING_COMPLETION *)((BYTE *)loader->cq_ring + parameters.cq_off.cqes);
+
+	drive(0, loader);
+	return (HANDLE)loader;
+}
+
+VOID *wait_for_file(HANDLE handle, SIZE index, SIZE *size)
+{
+	struct RING_LOADER *loader = (struct RING_LOADER *)handle;
+	struct RING_FILE *file = &loader->files[index];
+	while (!file->is_done) drive(1, loader);
+	file->is_taken = 1;
+	*size = file->size;
+	return file->data;
+}
+
+VOID end_loading_files(HANDLE handle)
+{
+	struct RING_LOADER *loader = (struct RING_LOADER *)handle;
+	loader->files_count = loader->next_file;
+	while (loader->in_flight_count) drive(1, loader);
+	for (SIZE i = 0; i < loader->files_count; ++i)
+		if (!loader->files[i].is_taken && loader->files[i].data) release_virtual_memory(loader->files[i].data, loader->files[i].size + loader->padding_size);
+	assert(!munmap(loader->submissions, loader->entries_count * sizeof(struct RING_SUBMISSION)));
+	assert(!munmap(loader->cq_ring, loader->cq_ring_size));
+	assert(!munmap(loader->sq_ring, loader->sq_ring_size));
+	assert(!close(loader->ring));
+	release_virtual_memory(loader, loader->memory_size);
+}
+
+#endif
@@ -5,14 +5,34 @@
 __declspec(dllimport) HANDLE  __stdcall CreateFileA  (const CHAR*, WORD, WORD, VOID*, WORD, WORD, HANDLE);
 __declspec(dllimport) BOOLEAN __stdcall GetFileSizeEx(HANDLE, SIZE *);
 __declspec(dllimport) BOOLEAN __stdcall ReadFile     (HANDLE, VOID *, WORD, WORD *, VOID *);
+__declspec(dllimport) BOOLEAN __stdcall WriteFile    (HANDLE, const VOID *, WORD, WORD *, VOID *);
 __declspec(dllimport) BOOLEAN __stdcall CloseHandle  (HANDLE);
+__declspec(dllimport) HANDLE  __stdcall GetStdHandle (WORD);
+__declspec(dllimport) WORD    __stdcall GetLastError (VOID);
 __declspec(dllimport) VOID    __stdcall GetSystemInfo(VOID *);
 __declspec(dllimport) VOID   *__stdcall VirtualAlloc (VOID *, SIZE, WORD, WORD);
 __declspec(dllimport) BOOLEAN __stdcall VirtualFree  (VOID *, SIZE, WORD);
+__declspec(dllimport) BOOLEAN __stdcall VirtualProtect(VOID *, SIZE, WORD, WORD *);
+__declspec(dllimport) HANDLE  __stdcall GetCurrentProcess(VOID);
+__declspec(dllimport) BOOLEAN __stdcall FlushInstructionCache(HANDLE, const VOID *, SIZE);
+__declspec(dllimport) HANDLE  __stdcall CreateThread (VOID *, SIZE, THREAD_PROCEDURE *, VOID *, WORD, WORD *);
+__declspec(dllimport) WORD    __stdcall WaitForSingleObject(HANDLE, WORD);
+__declspec(dllimport) BOOLEAN __stdcall SwitchToThread(VOID);
+__declspec(dllimport) BOOLEAN __stdcall QueryPerformanceCounter  (SIZE *);
+__declspec(dllimport) BOOLEAN __stdcall QueryPerformanceFrequency(SIZE *);
+__declspec(dllimport) BOOLEAN __stdcall GetFileAttributesExA(const CHAR *, WORD, VOID *);
+__declspec(dllimport) HANDLE  __stdcall FindFirstFileA(const CHAR *, VOID *);
+__declspec(dllimport) BOOLEAN __stdcall FindNextFileA (HANDLE, VOID *);
+__declspec(dllimport) BOOLEAN __stdcall FindClose     (HANDLE);
 
 HANDLE open_file(const char *path)
 {
-	HANDLE file = CreateFileA(path, 0x80000000L, 0x00000001, 0, 3, 0x00000080, 0);
+	return CreateFileA(path, 0x80000000L, 0x00000001, 0, 3, 0x00000080, 0);
+}
+
+HANDLE create_file(const CHAR *path)
+{
+	HANDLE file = CreateFileA(path, 0x40000000L, 0, 0, 2, 0x00000080, 0);
 	assert(file != -1);
 	return file;
 }
@@ -27,28 +47,150 @@ SIZE get_size_of_file(HANDLE file)
 SIZE read_from_file(VOID *buffer, SIZE size, HANDLE file)
 {
 	assert(size <= 0xffffffffffffffff);
-	assert(ReadFile(file, buffer, size, (WORD *)&size, 0));
+	if (!ReadFile(file, buffer, size, (WORD *)&size, 0)) {
+		/* a pipe whose writer is gone is at its end */
+		assert(GetLastError() == 0x6d);
+		return 0;
+	}
 	return size;
 }
 
+SIZE write_to_file(const VOID *buffer, SIZE size, HANDLE file)
+{
+	assert(size <= 0xffffffff);
+	WORD written_size;
+	assert(WriteFile(file, buffer, size, &written_size, 0));
+	return written_size;
+}
+
 VOID close_file(HANDLE file)
 {
 	assert(CloseHandle(file));
 }
 
+HANDLE get_standard_input(VOID)
+{
+	HANDLE file = GetStdHandle(0xfffffff6);
+	assert(file != -1);
+	return file;
+}
+
+HANDLE get_standard_output(VOID)
+{
+	HANDLE file = GetStdHandle(0xfffffff5);
+	assert(file != -1);
+	return file;
+}
+
+/* a `WIN32_FIND_DATAA`, which begins like a `WIN32_FILE_ATTRIBUTE_DATA` */
+struct FIND_DATA {
+	WORD dwFileAttributes;
+	WORD ftCreationTime[2];
+	WORD ftLastAccessTime[2];
+	WORD ftLastWriteTime[2];
+	WORD nFileSizeHigh;
+	WORD nFileSizeLow;
+	WORD dwReserved0;
+	WORD dwReserved1;
+	CHAR cFileName[260];
+	CHAR cAlternateFileName[14];
+};
+
+/* a reparse point that's a directory is another kind, since it may be a link */
+static enum FILE_KIND get_kind_of_file(WORD attributes)
+{
+	if (attributes & 0x400) return attributes & 0x10 ? FILE_KIND_other : FILE_KIND_regular;
+	return attributes & 0x10 ? FILE_KIND_directory : attributes & 0x40 ? FILE_KIND_other : FILE_KIND_regular;
+}
+
+enum FILE_KIND query_file(const CHAR *path, U64 *modification_time)
+{
+	struct FIND_DATA data;
+	if (!GetFileAttributesExA(path, 0, &data)) return FILE_KIND_none;
+	/* file times are in hundreds of nanoseconds */
+	*modification_time = ((U64)data.ftLastWriteTime[1] << 32 | data.ftLastWriteTime[0]) * 100;
+	return get_kind_of_file(data.dwFileAttributes);
+}
+
+BOOLEAN list_directory(const CHAR *path, DIRECTORY_VISITOR *visit, VOID *parameter)
+{
+	CHAR pattern[260 + 2];
+	SIZE size = 0;
+	while (path[size]) ++size;
+	if (size + 2 >= sizeof(pattern)) return 0;
+	for (SIZE i = 0; i < size; ++i) pattern[i] = path[i];
+	pattern[size] = '\\';
+	pattern[size + 1] = '*';
+	pattern[size + 2] = 0;
+
+	struct FIND_DATA data;
+	HANDLE find = FindFirstFileA(pattern, &data);
+	if (find == -1) return 0;
+	do {
+		const CHAR *name = data.cFileName;
+		if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2]))) continue;
+		visit(name, get_kind_of_file(data.dwFileAttributes), parameter);
+	} while (FindNextFileA(find, &data));
+	assert(FindClose(find));
+	return 1;
+}
+
+union SYSTEM_INFO {
+	WORD _padding0[16];
+	struct {
+		BYTE _padding1[4];
+		WORD dwPageSize;
+		BYTE _padding2[24];
+		WORD dwNumberOfProcessors;
+	};
+};
+
 SIZE query_system_page_size(VOID)
 {
-	union {
-		WORD _padding0[16];
-		struct {
-			BYTE _padding1[4];
-			WORD dwPageSize;
-		};
-	} system_info;
+	union SYSTEM_INFO system_info;
 	GetSystemInfo(&system_info);
 	return system_info.dwPageSize;
 }
 
+SIZE query_processor_count(VOID)
+{
+	union SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	return system_info.dwNumberOfProcessors;
+}
+
+SIZE query_performance_counter(VOID)
+{
+	SIZE counter;
+	assert(QueryPerformanceCounter(&counter));
+	return counter;
+}
+
+SIZE query_performance_frequency(VOID)
+{
+	SIZE frequency;
+	assert(QueryPerformanceFrequency(&frequency));
+	return frequency;
+}
+
+/* the counters are unavailable, so there's never one to read or close */
+HANDLE open_event_counter(enum EVENT event)
+{
+	(VOID)event;
+	return -1;
+}
+
+U64 read_event_counter(HANDLE counter)
+{
+	(VOID)counter;
+	return 0;
+}
+
+VOID close_event_counter(HANDLE counter)
+{
+	(VOID)counter;
+}
+
 VOID *allocate_virtual_memory(SIZE size)
 {
 	VOID *result = VirtualAlloc(0, size, 0x00001000 | 0x00002000, 0x04);
@@ -68,10 +210,40 @@ VOID commit_virtual_memory(VOID *memory, SIZE size)
 	assert(VirtualAlloc(memory, size, 0x00001000, 0x04));
 }
 
+VOID decommit_virtual_memory(VOID *memory, SIZE size)
+{
+	assert(VirtualFree(memory, size, 0x00004000));
+}
+
+VOID protect_virtual_memory(VOID *memory, SIZE size, BOOLEAN is_executable)
+{
+	WORD old_protection;
+	assert(VirtualProtect(memory, size, is_executable ? 0x20 : 0x04, &old_protection));
+	if (is_executable) assert(FlushInstructionCache(GetCurrentProcess(), memory, size));
+}
+
 VOID release_virtual_memory(VOID *memory, SIZE size)
 {
 	(VOID)size;
 	assert(VirtualFree(memory, 0, 0x00008000));
 }
 
+HANDLE create_thread(THREAD_PROCEDURE *procedure, VOID *parameter)
+{
+	HANDLE thread = CreateThread(0, 0, procedure, parameter, 0, 0);
+	assert(thread);
+	return thread;
+}
+
+VOID join_thread(HANDLE thread)
+{
+	assert(WaitForSingleObject(thread, 0xffffffff) == 0);
+	assert(CloseHandle(thread));
+}
+
+VOID yield_thread(VOID)
+{
+	(VOID)SwitchToThread();
+}
+
 #endif
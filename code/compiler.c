@@ -29,6 +29,10 @@ static inline SIZE get_size_of_string(const VOID *source) {
 	return __builtin_strlen(source);
 }
 
+static inline S32 compare_strings(const CHAR *left, const CHAR *right) {
+	return __builtin_strcmp(left, right);
+}
+
 static inline SIZE get_forward_alignment(ADDRESS address, SIZE alignment) {
 	SIZE remainder = alignment ? address & (alignment - 1) : 0;
 	return remainder ? alignment - remainder : 0;
@@ -44,14 +48,15 @@ struct BUFFER {
 	VOID *data;
 	SIZE data_size;
 	SIZE commission_size;
+	SIZE peak_size; /* the most that's been committed for */
 };
 
 typedef struct BUFFER C_BUFFER;
 
 #define DEFAULT_BUFFER (struct BUFFER){ .reservation_size = 0, .commission_rate = 0, .data = 0 }
 
-static VOID *push(SIZE size, SIZE alignment, struct BUFFER *buffer) {
-	assert(alignment % 2 == 0);
+/* commits what's needed for `size` more bytes, without pushing them */
+static VOID commit_buffer(SIZE size, struct BUFFER *buffer) {
 	if (!buffer->data) {
 		if (!buffer->reservation_size) buffer->reservation_size = GIBIBYTES(1);
 		if (!buffer->commission_rate) buffer->commission_rate = query_system_page_size();
@@ -60,12 +65,20 @@ static VOID *push(SIZE size, SIZE alignment, struct BUFFER *buffer) {
 		buffer->commission_size = buffer->commission_rate;
 		buffer->data_size = 0;
 	}
-	SIZE forward_alignment = get_forward_alignment((ADDRESS)buffer->data, alignment);
-	if (buffer->data_size + forward_alignment + size >= buffer->commission_size) {
-		assert(buffer->commission_size + buffer->commission_rate <= buffer->reservation_size);
-		commit_virtual_memory((BYTE *)buffer->data + buffer->commission_size, buffer->commission_rate);
-		buffer->commission_size += buffer->commission_rate;
+	SIZE data_size = buffer->data_size + size;
+	if (data_size > buffer->peak_size) buffer->peak_size = data_size;
+	if (data_size > buffer->commission_size) {
+		SIZE commission_size = align_forwards(data_size, buffer->commission_rate);
+		assert(commission_size <= buffer->reservation_size);
+		commit_virtual_memory((BYTE *)buffer->data + buffer->commission_size, commission_size - buffer->commission_size);
+		buffer->commission_size = commission_size;
 	}
+}
+
+static VOID *push(SIZE size, SIZE alignment, struct BUFFER *buffer) {
+	assert(alignment && !(alignment & (alignment - 1)));
+	SIZE forward_alignment = buffer->data ? get_forward_alignment((ADDRESS)buffer->data + buffer->data_size, alignment) : 0;
+	commit_buffer(forward_alignment + size, buffer);
 	buffer->data_size += forward_alignment;
 	VOID *result = buffer->data + buffer->data_size;
 	buffer->data_size += size;
@@ -73,8 +86,146 @@ static VOID *push(SIZE size, SIZE alignment, struct BUFFER *buffer) {
 	return result;
 }
 
+/* decommits what's past `size` (or what's used, if that's more) */
+static VOID trim_buffer(SIZE size, struct BUFFER *buffer) {
+	if (!buffer->data) return;
+	if (size < buffer->data_size) size = buffer->data_size;
+	SIZE commission_size = align_forwards(size, buffer->commission_rate);
+	if (commission_size >= buffer->commission_size) return;
+	decommit_virtual_memory((BYTE *)buffer->data + commission_size, buffer->commission_size - commission_size);
+	buffer->commission_size = commission_size;
+}
+
 typedef U32 COUNT;
 
+static inline U64 hash_bytes(const VOID *bytes, SIZE size) {
+	U64 hash = 0xcbf29ce484222325;
+	for (SIZE i = 0; i < size; ++i)
+		hash = (hash ^ ((const BYTE *)bytes)[i]) * 0x100000001b3;
+	return hash;
+}
+
+static inline U64 mix_hash(U64 hash, U64 value) {
+	hash = (hash ^ value) * 0xff51afd7ed558ccd;
+	return hash ^ hash >> 32;
+}
+
+/*
+NOTE(Emhyr): names are interned so that they're compared and hashed as
+integers. a symbol is an index into `symbols`, and 0 is never a symbol.
+*/
+
+typedef U32 SYMBOL;
+
+struct INTERNED {
+	SIZE offset; /* into `texts` */
+	COUNT size;
+	U32 hash;
+};
+
+struct INTERNER {
+	struct BUFFER texts;
+	struct BUFFER symbols;
+	SYMBOL *slots;
+	COUNT slots_count;
+	COUNT symbols_count;
+};
+
+static inline const CHAR *get_symbol_text(SYMBOL symbol, COUNT *size, const struct INTERNER *interner) {
+	const struct INTERNED *interned = (const struct INTERNED *)interner->symbols.data + symbol;
+	*size = interned->size;
+	return (const CHAR *)interner->texts.data + interned->offset;
+}
+
+static VOID rehash_interner(COUNT slots_count, struct INTERNER *interner) {
+	SYMBOL *slots = allocate_virtual_memory(slots_count * sizeof(SYMBOL));
+	for (COUNT i = 0; i < interner->slots_count; ++i) {
+		SYMBOL symbol = interner->slots[i];
+		if (!symbol) continue;
+		COUNT j = ((struct INTERNED *)interner->symbols.data)[symbol].hash & (slots_count - 1);
+		while (slots[j]) j = (j + 1) & (slots_count - 1);
+		slots[j] = symbol;
+	}
+	if (interner->slots) release_virtual_memory(interner->slots, interner->slots_count * sizeof(SYMBOL));
+	interner->slots = slots;
+	interner->slots_count = slots_count;
+	if (!interner->symbols_count && !interner->symbols.data_size) (VOID)push(sizeof(struct INTERNED), alignof(struct INTERNED), &interner->symbols);
+}
+
+static SYMBOL intern(const CHAR *text, COUNT size, struct INTERNER *interner) {
+	if (interner->symbols_count * 2 >= interner->slots_count)
+		rehash_interner(interner->slots_count ? interner->slots_count * 2 : 1024, interner);
+
+	U32 hash = hash_bytes(text, size);
+	COUNT i = hash & (interner->slots_count - 1);
+	for (SYMBOL symbol; (symbol = interner->slots[i]); i = (i + 1) & (interner->slots_count - 1)) {
+		const struct INTERNED *interned = (const struct INTERNED *)interner->symbols.data + symbol;
+		if (interned->hash == hash && interned->size == size && !__builtin_memcmp((const CHAR *)interner->texts.data + interned->offset, text, size))
+			return symbol;
+	}
+
+	struct INTERNED *interned = push(sizeof(struct INTERNED), alignof(struct INTERNED), &interner->symbols);
+	interned->offset = interner->texts.data_size;
+	interned->size = size;
+	interned->hash = hash;
+	copy(push(size, 1, &interner->texts), text, size);
+	return interner->slots[i] = ++interner->symbols_count;
+}
+
+/*
+NOTE(Emhyr): threads can intern into the same interner at once, so that a
+symbol means the same thing to every one of them, but only between a call to
+`prepare_to_intern` and the next call to `intern`. it makes the table and the
+buffers big enough for what the threads could intern, so that nothing's ever
+grown or committed while they're at it, and then:
+
+- a symbol and its text are appended by adding to the buffers' sizes
+  atomically, and they're written before the symbol is published;
+- a symbol's published by compare-and-swapping it into an empty slot, and a
+  slot's never emptied or overwritten, so a probe that's seen a symbol can
+  trust it;
+- a thread that loses a slot to the same text uses the winner's symbol, and
+  what it had appended is left unused. so symbols aren't dense after that,
+  which is fine since they're only ever compared.
+*/
+
+/*
+makes room for `symbols_count` new texts that are `texts_size` bytes in all.
+every thread that's in the race for a new text can append it, so the buffers
+are made `threads_count` times as big.
+*/
+static VOID prepare_to_intern(COUNT symbols_count, SIZE texts_size, COUNT threads_count, struct INTERNER *interner) {
+	COUNT slots_count = interner->slots_count ? interner->slots_count : 1024;
+	while ((U64)(interner->symbols_count + symbols_count) * 2 >= slots_count) slots_count *= 2;
+	if (slots_count != interner->slots_count) rehash_interner(slots_count, interner);
+	commit_buffer((SIZE)symbols_count * threads_count * sizeof(struct INTERNED), &interner->symbols);
+	commit_buffer(texts_size * threads_count, &interner->texts);
+}
+
+static SYMBOL intern_concurrently(const CHAR *text, COUNT size, struct INTERNER *interner) {
+	U32 hash = hash_bytes(text, size);
+	COUNT mask = interner->slots_count - 1;
+	SYMBOL appended = 0;
+	for (COUNT i = hash & mask;; i = (i + 1) & mask) {
+		SYMBOL symbol = __atomic_load_n(&interner->slots[i], __ATOMIC_ACQUIRE);
+		if (!symbol) {
+			if (!appended) {
+				SIZE offset = __atomic_fetch_add(&interner->texts.data_size, size, __ATOMIC_RELAXED);
+				assert(offset + size <= interner->texts.commission_size);
+				copy((CHAR *)interner->texts.data + offset, text, size);
+				appended = __atomic_fetch_add(&interner->symbols.data_size, sizeof(struct INTERNED), __ATOMIC_RELAXED) / sizeof(struct INTERNED);
+				assert((appended + 1) * sizeof(struct INTERNED) <= interner->symbols.commission_size);
+				(VOID)__atomic_fetch_add(&interner->symbols_count, 1, __ATOMIC_RELAXED);
+				((struct INTERNED *)interner->symbols.data)[appended] = (struct INTERNED){ .offset = offset, .size = size, .hash = hash };
+			}
+			if (__atomic_compare_exchange_n(&interner->slots[i], &symbol, appended, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) return appended;
+		}
+		const struct INTERNED *interned = (const struct INTERNED *)interner->symbols.data + symbol;
+		if (interned->hash == hash && interned->size == size && !__builtin_memcmp((const CHAR *)interner->texts.data + interned->offset, text, size))
+			return symbol;
+	}
+}
+
 typedef BYTE UTF8;
 typedef WORD UTF32;
 
@@ -141,23 +292,116 @@ struct SOURCE {
 	COUNT size;
 };
 
+/* the data is 0 if the file can't be opened */
 static struct SOURCE load_source(const CHAR *path) {
 	assert(get_size_of_string(path) <= MAXIMUM_PATH_SIZE);
 
+	struct SOURCE source = { 0 };
+	copy(source.path, path, get_size_of_string(path));
 	HANDLE file = open_file(path);
+	if (file == -1) return source;
 	SIZE size = get_size_of_file(file);
 	assert(size < (COUNT)-1);
 	VOID *data = allocate_virtual_memory(size + sizeof(UTF32));
 	(void)read_from_file(data, size, file);
+	close_file(file);
 
-	struct SOURCE source = { .data = data, .size = size };
-	copy(source.path, path, get_size_of_string(path));
+	source.data = data;
+	source.size = size;
 	return source;
 }
 
+/*
+NOTE(Emhyr): sources are loaded ahead of their compilation, so that compiling
+one overlaps with loading the rest. on Linux, the platform loads them with
+io_uring if it can; otherwise, a few threads do.
+*/
+
+struct LOADED_SOURCE {
+	struct SOURCE source;
+	BOOLEAN is_loaded;
+	BOOLEAN is_taken;
+};
+
+struct LOADER {
+	HANDLE platform_loader; /* 0 if the platform can't load */
+	const CHAR **paths;
+	struct LOADED_SOURCE *sources;
+	COUNT sources_count;
+	COUNT next_source; /* that no thread is loading yet */
+	HANDLE *threads;
+	COUNT threads_count;
+	struct BUFFER buffer;
+};
+
+#define LOADING_THREADS_COUNT 8
+
+static WORD load_sources(VOID *parameter) {
+	struct LOADER *loader = parameter;
+	for (;;) {
+		COUNT i = __atomic_fetch_add(&loader->next_source, 1, __ATOMIC_RELAXED);
+		if (i >= loader->sources_count) break;
+		loader->sources[i].source = load_source(loader->paths[i]);
+		__atomic_store_n(&loader->sources[i].is_loaded, 1, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+
+/* the paths are copied, but not what they point to */
+static VOID begin_loading_sources(const CHAR *const *paths, COUNT paths_count, struct LOADER *loader) {
+	*loader = (struct LOADER){ .sources_count = paths_count, .buffer = DEFAULT_BUFFER };
+	loader->paths = push(paths_count * sizeof(CHAR *), alignof(CHAR *), &loader->buffer);
+	copy(loader->paths, paths, paths_count * sizeof(CHAR *));
+	loader->sources = push(paths_count * sizeof(struct LOADED_SOURCE), alignof(struct LOADED_SOURCE), &loader->buffer);
+#if defined(__linux__)
+	loader->platform_loader = begin_loading_files(loader->paths, paths_count, sizeof(UTF32));
+	if (loader->platform_loader) return;
+#endif
+
+	loader->threads_count = paths_count < LOADING_THREADS_COUNT ? paths_count : LOADING_THREADS_COUNT;
+	loader->threads = push(loader->threads_count * sizeof(HANDLE), alignof(HANDLE), &loader->buffer);
+	for (COUNT i = 0; i < loader->threads_count; ++i)
+		loader->threads[i] = create_thread(load_sources, loader);
+}
+
+/* the source's data is the caller's */
+static struct SOURCE wait_for_source(COUNT index, struct LOADER *loader) {
+	struct LOADED_SOURCE *loaded = &loader->sources[index];
+#if defined(__linux__)
+	if (loader->platform_loader) {
+		SIZE size;
+		loaded->source.data = wait_for_file(loader->platform_loader, index, &size);
+		assert(size < (COUNT)-1);
+		loaded->source.size = size;
+		copy(loaded->source.path, loader->paths[index], get_size_of_string(loader->paths[index]));
+	} else
+#endif
+	while (!__atomic_load_n(&loaded->is_loaded, __ATOMIC_ACQUIRE)) yield_thread();
+	loaded->is_taken = 1;
+	return loaded->source;
+}
+
+static VOID end_loading_sources(struct LOADER *loader) {
+#if defined(__linux__)
+	if (loader->platform_loader) end_loading_files(loader->platform_loader);
+	else
+#endif
+	{
+		for (COUNT i = 0; i < loader->threads_count; ++i)
+			join_thread(loader->threads[i]);
+		for (COUNT i = 0; i < loader->sources_count; ++i) {
+			const struct LOADED_SOURCE *loaded = &loader->sources[i];
+			if (!loaded->is_taken && loaded->source.data) release_virtual_memory(loaded->source.data, loaded->source.size + sizeof(UTF32));
+		}
+	}
+	release_virtual_memory(loader->buffer.data, loader->buffer.reservation_size);
+	*loader = (struct LOADER){ 0 };
+}
+
 enum CHARACTER {
 	CHARACTER_unknown,
 	CHARACTER_whitespace,
+	CHARACTER_newline,
 	CHARACTER_terminator,
 	CHARACTER_full_stop,            /* . */
 	CHARACTER_low_line,             /* _ */
@@ -219,7 +463,7 @@ struct LEXER {
 static const enum CHARACTER character_from_codepoint[MAXIMUM_CODEPOINT_VALUE] = {
 	[0 ...MAXIMUM_CODEPOINT_VALUE - 1] = CHARACTER_unknown,
 	['\t'] = CHARACTER_whitespace,
-	['\n'] = CHARACTER_whitespace,
+	['\n'] = CHARACTER_newline,
 	['\v'] = CHARACTER_whitespace,
 	['\f'] = CHARACTER_whitespace,
 	['\r'] = CHARACTER_whitespace,
@@ -601,13 +845,20 @@ static const WORD lexer_state_from_character[LEXER_STATES_COUNT][CHARACTERS_COUN
 
 static VOID advance_lexer(struct LEXER *lexer) {
 	lexer->position += lexer->increment;
-	if (lexer->character == '\n') {
+	if (lexer->character == CHARACTER_newline) {
 		++lexer->row;
 		lexer->column = 0;
 	}
 	++lexer->column;
 
-	if (lexer->position < lexer->source.size) {
+	if (lexer->position >= lexer->source.size) {
+		lexer->increment = 0;
+		lexer->character = CHARACTER_terminator;
+	} else if ((UTF8)lexer->source.data[lexer->position] < 0x80) {
+		/* most of a source is ascii, which needn't be decoded */
+		lexer->increment = 1;
+		lexer->character = character_from_codepoint[(UTF8)lexer->source.data[lexer->position]];
+	} else {
 		const UTF8 bytes[4] = {
 			lexer->source.data[lexer->position + 0],
 			lexer->source.data[lexer->position + 1],
@@ -617,14 +868,11 @@ static VOID advance_lexer(struct LEXER *lexer) {
 		struct UNICODE_DECODING decoding = decode_utf8(bytes);
 		lexer->increment = decoding.increment;
 		lexer->character = decoding.codepoint <= MAXIMUM_CODEPOINT_VALUE ? character_from_codepoint[decoding.codepoint] : CHARACTER_unknown;
-	} else {
-		lexer->increment = 0;
-		lexer->character = CHARACTER_terminator;
 	}
 }
 
 static struct TOKEN lex(struct LEXER *lexer) {
-	while (lexer->character == CHARACTER_whitespace)
+	while (lexer->character == CHARACTER_whitespace || lexer->character == CHARACTER_newline)
 		advance_lexer(lexer);
 	
 	struct TOKEN token;
@@ -647,15 +895,17 @@ static struct TOKEN lex(struct LEXER *lexer) {
 	return token;
 }
 
-static struct LEXER create_lexer(const CHAR *path) {
+/* lexes `range` of `source`, whose `row` and `column` are those of `range->beginning` */
+static struct LEXER create_lexer(const struct SOURCE *source, const struct RANGE *range) {
 	struct LEXER lexer = {
-		.source    = load_source(path),
-		.position  = 0,
-		.row       = 0,
-		.column    = 0,
+		.source    = *source,
+		.position  = range->beginning,
+		.row       = range->row,
+		.column    = range->column - 1,
 		.increment = 0,
-		.character = '\n'
+		.character = CHARACTER_unknown
 	};
+	lexer.source.size = range->ending;
 	advance_lexer(&lexer);
 	return lexer;
 }
@@ -723,6 +973,125 @@ static const CHAR string_from_token_tag[][32] = {
 	[TOKEN_TAG_vertical_bar_equal_sign       ] = "vertical_bar_equal_sign",
 };
 
+/*
+NOTE(Emhyr): a `struct TOKEN` is 20 bytes, but most tokens are a few bytes
+long and begin a space or so past where the one before ended. so when tokens
+are kept, they're kept as a tag each, in one array, and their ranges as deltas
+from the one before, in another: the gap and the length, each as a varint. a
+token that isn't on the row of the one before, or whose column doesn't follow
+from the gap (after a string with newlines, say), is flagged as displaced in
+its tag, and its row's delta and its column follow.
+
+they're decoded in order by a cursor, which is the range of the token before
+and where the next one's deltas begin. every `TOKENS_CHECKPOINT_INTERVAL`th
+token has its cursor checkpointed, so seeking decodes fewer than that many.
+*/
+
+enum {
+	TOKEN_DISPLACEMENT_FLAG    = 0x80,
+	TOKENS_CHECKPOINT_INTERVAL = 64,
+	MAXIMUM_VARINT_SIZE        = 5,
+};
+
+_Static_assert((int)TOKEN_TAGS_COUNT <= (int)TOKEN_DISPLACEMENT_FLAG, "a token's tag must leave its displacement flag free");
+
+struct TOKEN_CURSOR {
+	COUNT index; /* of the next token */
+	COUNT deltas_position;
+	struct RANGE range; /* of the token before */
+};
+
+struct TOKENS {
+	struct BUFFER tags;
+	struct BUFFER deltas;
+	struct BUFFER checkpoints;
+	COUNT tokens_count;
+	struct TOKEN_CURSOR ending; /* past the last token */
+};
+
+static inline WORD encode_varint(COUNT value, BYTE *bytes) {
+	WORD size = 0;
+	for (; value >= 0x80; value >>= 7) bytes[size++] = value | 0x80;
+	bytes[size++] = value;
+	return size;
+}
+
+static inline COUNT decode_varint(const BYTE **bytes) {
+	const BYTE *byte = *bytes;
+	COUNT value = *byte & 0x7f;
+	for (WORD shift = 7; *byte++ & 0x80; shift += 7) value |= (COUNT)(*byte & 0x7f) << shift;
+	*bytes = byte;
+	return value;
+}
+
+static VOID append_token(const struct TOKEN *token, struct TOKENS *tokens) {
+	struct TOKEN_CURSOR *cursor = &tokens->ending;
+	if (!(cursor->index % TOKENS_CHECKPOINT_INTERVAL))
+		*(struct TOKEN_CURSOR *)push(sizeof(struct TOKEN_CURSOR), alignof(struct TOKEN_CURSOR), &tokens->checkpoints) = *cursor;
+
+	BOOLEAN is_displaced = token->range.row != cursor->range.row || token->range.column != cursor->range.column + (token->range.beginning - cursor->range.beginning);
+	*(BYTE *)push(1, 1, &tokens->tags) = token->tag | (is_displaced ? TOKEN_DISPLACEMENT_FLAG : 0);
+
+	commit_buffer(4 * MAXIMUM_VARINT_SIZE, &tokens->deltas);
+	BYTE *bytes = (BYTE *)tokens->deltas.data + tokens->deltas.data_size;
+	WORD size = encode_varint(token->range.beginning - cursor->range.ending, bytes);
+	size += encode_varint(token->range.ending - token->range.beginning, bytes + size);
+	if (is_displaced) {
+		size += encode_varint(token->range.row - cursor->range.row, bytes + size);
+		size += encode_varint(token->range.column, bytes + size);
+	}
+	tokens->deltas.data_size += size;
+
+	cursor->index += 1;
+	cursor->deltas_position = tokens->deltas.data_size;
+	cursor->range = token->range;
+	tokens->tokens_count += 1;
+}
+
+/* returns a terminator past the last token */
+static inline struct TOKEN decode_token(const struct TOKENS *tokens, struct TOKEN_CURSOR *cursor) {
+	if (cursor->index == tokens->tokens_count) return (struct TOKEN){ .tag = TOKEN_TAG_terminator, .range = { cursor->range.ending, cursor->range.ending, cursor->range.row, cursor->range.column } };
+	BYTE tag = ((const BYTE *)tokens->tags.data)[cursor->index];
+	const BYTE *bytes = (const BYTE *)tokens->deltas.data + cursor->deltas_position;
+	struct TOKEN token;
+	token.tag = tag & ~TOKEN_DISPLACEMENT_FLAG;
+	token.range.beginning = cursor->range.ending + decode_varint(&bytes);
+	token.range.ending = token.range.beginning + decode_varint(&bytes);
+	if (tag & TOKEN_DISPLACEMENT_FLAG) {
+		token.range.row = cursor->range.row + decode_varint(&bytes);
+		token.range.column = decode_varint(&bytes);
+	} else {
+		token.range.row = cursor->range.row;
+		token.range.column = cursor->range.column + (token.range.beginning - cursor->range.beginning);
+	}
+	cursor->index += 1;
+	cursor->deltas_position = bytes - (const BYTE *)tokens->deltas.data;
+	cursor->range = token.range;
+	return token;
+}
+
+/* returns a cursor at the `index`th token */
+static struct TOKEN_CURSOR seek_token(COUNT index, const struct TOKENS *tokens) {
+	assert(index <= tokens->tokens_count);
+	if (index == tokens->tokens_count) return tokens->ending;
+	struct TOKEN_CURSOR cursor = ((const struct TOKEN_CURSOR *)tokens->checkpoints.data)[index / TOKENS_CHECKPOINT_INTERVAL];
+	while (cursor.index < index) (VOID)decode_token(tokens, &cursor);
+	return cursor;
+}
+
+/* appends the tokens of `range` of `source`, without its terminator */
+static VOID tokenize(const struct SOURCE *source, const struct RANGE *range, struct TOKENS *tokens) {
+	struct LEXER lexer = create_lexer(source, range);
+	for (struct TOKEN token; (token = lex(&lexer)).tag != TOKEN_TAG_terminator;) append_token(&token, tokens);
+}
+
+static VOID release_tokens(struct TOKENS *tokens) {
+	if (tokens->tags.data) release_virtual_memory(tokens->tags.data, tokens->tags.reservation_size);
+	if (tokens->deltas.data) release_virtual_memory(tokens->deltas.data, tokens->deltas.reservation_size);
+	if (tokens->checkpoints.data) release_virtual_memory(tokens->checkpoints.data, tokens->checkpoints.reservation_size);
+	*tokens = (struct TOKENS){ 0 };
+}
+
 enum SEVERITY {
 	SEVERITY_verbose,
 	SEVERITY_comment,
@@ -765,11 +1134,17 @@ __attribute__((noreturn))
 extern VOID _exit(WORD);
 
 /*
-TODO(Emhyr): instead of exiting, `longjmp` to an "error handler" that
-simpley deallocates memory and skips to a terminator token. the error handler
-would usually be within the iteration that parses statements.
+NOTE(Emhyr): when serving, `fail` unwinds to the request that's being served
+instead of exiting. it's a `__builtin_longjmp`, so it must only be called on the
+thread that set the recovery point; that's why the server parses on one thread.
+
+TODO(Emhyr): skip to a terminator token instead, so that a bad statement
+doesn't fail the rest of the source.
 */
 
+static VOID *recovery_point[5];
+static BOOLEAN is_recoverable;
+
 __attribute__((noreturn))
 static VOID fail(const struct SOURCE *source, const struct RANGE *range, const CHAR *message, ...) {
 	if (message) {
@@ -778,6 +1153,8 @@ static VOID fail(const struct SOURCE *source, const struct RANGE *range, const C
 		report_v(SEVERITY_failure, source, range, message, vargs);
 		end_vargs(vargs);
 	}
+	fflush(stdout);
+	if (is_recoverable) __builtin_longjmp(recovery_point, 1);
 	_exit(-1);
 }
 
@@ -825,10 +1202,12 @@ enum NODE_TAG {
 	NODE_TAG_indexation,                /* `[` expression `]` */
 	NODE_TAG_resolution,                /* expression `.` expression */
 	/* typing */
+	NODE_TAG_name,                      /* word */
 	NODE_TAG_record,                    /* `(` [value-declaration {`,` value-declaration}] `)` */
 	NODE_TAG_pointer,                   /* `@` type */
 	NODE_TAG_array,                     /* `[` expression `]` type */
 	NODE_TAG_lambda,                    /* `(` [value-declaration {`,` value-declaration}] `)` `->` type */
+	NODE_TAG_field,                     /* word `:` type */
 	NODE_TAG_cast,                      /* expression `:` type */
 	/* assignment */
 	NODE_TAG_assignment,                /* expression `=` expression */
@@ -851,11 +1230,46 @@ enum NODE_TAG {
 	NODE_TAGS_COUNT,
 };
 
+typedef U32 TYPE; /* 0 is no type */
+
+/*
+only set for literals once they're evaluated, for types and casts once they're
+interned, and for references once they're resolved.
+*/
+union VALUE {
+	U64 natural;
+	F64 real;
+	SYMBOL symbol;
+	TYPE type;
+	COUNT declaration;
+};
+
 struct NODE {
 	enum NODE_TAG tag;
+	COUNT count; /* of the nodes in its subtree, itself included */
 	struct RANGE range;
+	union VALUE value;
 };
 
+/*
+NOTE(Emhyr): nodes are stored in prefix order, so a node's children follow it
+immediately, and its subtree is `count` nodes long. hence, any subtree can be
+skipped without visiting its descendants.
+*/
+
+static inline struct NODE *skip_subtree(const struct NODE *node) {
+	return (struct NODE *)node + node->count;
+}
+
+static inline struct NODE *get_first_child(const struct NODE *node) {
+	return node->count > 1 ? (struct NODE *)node + 1 : 0;
+}
+
+static inline struct NODE *get_next_sibling(const struct NODE *node, const struct NODE *parent) {
+	struct NODE *sibling = skip_subtree(node);
+	return sibling < skip_subtree(parent) ? sibling : 0;
+}
+
 typedef BYTE PRECEDENCE;
 
 static const PRECEDENCE precedence_from_node_tag[] = {
@@ -900,13 +1314,66 @@ static const PRECEDENCE precedence_from_node_tag[] = {
 	[NODE_TAG_junction                 ] = 1,
 };
 
+/*
+NOTE(Emhyr): a source's structure is where each bracket's body and each
+string is, found before it's parsed. the parser can be given it, and then it
+skips a body in an expression without lexing it: an indexation or a
+subexpression is left as a single node, which it can't be otherwise, and
+it's only parsed once something asks for it. a body that doesn't parse is
+only found then.
+*/
+
+struct STRUCTURAL {
+	COUNT beginning;     /* of the opening bracket or quote */
+	COUNT ending;        /* past the closing one, or 0 if there's none */
+	COUNT ending_row;
+	COUNT ending_column;
+	COUNT next;          /* the first structural that isn't within this one */
+	BYTE opening;
+};
+
+struct STRUCTURE {
+	struct STRUCTURAL *structurals; /* by `beginning` */
+	COUNT structurals_count;
+};
+
 struct PARSER {
 	struct LEXER lexer;
 	struct TOKEN token;
+	const struct STRUCTURE *structure; /* to skip bodies with, if any */
+	COUNT next_structural;
+	C_BUFFER *stack; /* of what's being parsed (see `PARSING`) */
 };
 
-static struct NODE *parse_expression(C_BUFFER *buffer, PRECEDENCE other_precedence, struct PARSER *parser);
-static struct NODE *parse_type      (C_BUFFER *buffer, struct PARSER *parser);
+/* the body that's opened at `position`, if it's closed within what's being parsed */
+static const struct STRUCTURAL *find_body(COUNT position, BYTE opening, struct PARSER *parser) {
+	const struct STRUCTURE *structure = parser->structure;
+	COUNT i = parser->next_structural;
+	while (i < structure->structurals_count && structure->structurals[i].beginning < position) {
+		const struct STRUCTURAL *structural = &structure->structurals[i];
+		i = structural->ending && structural->ending <= position ? structural->next : i + 1;
+	}
+	parser->next_structural = i;
+	if (i == structure->structurals_count) return 0;
+	const struct STRUCTURAL *structural = &structure->structurals[i];
+	if (structural->beginning != position || structural->opening != opening || !structural->ending || structural->ending > parser->lexer.source.size) return 0;
+	return structural;
+}
+
+static VOID skip_body(const struct STRUCTURAL *body, struct PARSER *parser) {
+	parser->next_structural = body->next;
+	parser->lexer.position  = body->ending;
+	parser->lexer.row       = body->ending_row;
+	parser->lexer.column    = body->ending_column - 1;
+	parser->lexer.increment = 0;
+	parser->lexer.character = CHARACTER_unknown;
+	advance_lexer(&parser->lexer);
+	parser->token = lex(&parser->lexer);
+}
+
+static inline BOOLEAN is_deferred(const struct NODE *node) {
+	return (node->tag == NODE_TAG_indexation || node->tag == NODE_TAG_subexpression) && node->count == 1;
+}
 
 /* NOTE(Emhyr): i like tables... */
 
@@ -952,9 +1419,21 @@ static const enum NODE_TAG binary_node_tag_from_token_tag[TOKEN_TAGS_COUNT] = {
 	[TOKEN_TAG_lessthan_sign_equal_sign   ] = NODE_TAG_lesser_equality,
 	[TOKEN_TAG_comma                      ] = NODE_TAG_junction,
 	[TOKEN_TAG_equal_sign                 ] = NODE_TAG_assignment,
+	[TOKEN_TAG_plus_sign_equal_sign       ] = NODE_TAG_addition_assignment,
+	[TOKEN_TAG_hyphenminus_equal_sign     ] = NODE_TAG_subtraction_assignment,
+	[TOKEN_TAG_asterisk_equal_sign        ] = NODE_TAG_multiplication_assignment,
+	[TOKEN_TAG_slash_equal_sign           ] = NODE_TAG_division_assignment,
+	[TOKEN_TAG_percent_sign_equal_sign    ] = NODE_TAG_remainder_assignment,
+	[TOKEN_TAG_ampersand_equal_sign       ] = NODE_TAG_and_assignment,
+	[TOKEN_TAG_vertical_bar_equal_sign    ] = NODE_TAG_or_assignment,
+	[TOKEN_TAG_circumflex_accent_equal_sign] = NODE_TAG_xor_assignment,
+	[TOKEN_TAG_lessthan_sign_2_equal_sign ] = NODE_TAG_lsh_assignment,
+	[TOKEN_TAG_greaterthan_sign_2_equal_sign] = NODE_TAG_rsh_assignment,
 	[TOKEN_TAG_question_mark              ] = NODE_TAG_implication,
 	[TOKEN_TAG_colon                      ] = NODE_TAG_cast,
+	[TOKEN_TAG_full_stop                  ] = NODE_TAG_resolution,
 	[TOKEN_TAG_semicolon                  ] = NODE_TAG_nil,
+	[TOKEN_TAG_exclamation_mark           ] = NODE_TAG_nil, /* ends the consequent of an implication */
 	[TOKEN_TAG_right_parenthesis          ] = NODE_TAG_nil,
 	[TOKEN_TAG_right_square_bracket       ] = NODE_TAG_nil,
 };
@@ -992,10 +1471,12 @@ static const CHAR string_from_node_tag[][32] = {
 	[NODE_TAG_address                  ] = "address",
 	[NODE_TAG_indexation               ] = "indexation",
 	[NODE_TAG_resolution               ] = "resolution",
+	[NODE_TAG_name                     ] = "name",
 	[NODE_TAG_record                   ] = "record",
 	[NODE_TAG_pointer                  ] = "pointer",
 	[NODE_TAG_array                    ] = "array",
 	[NODE_TAG_lambda                   ] = "lambda",
+	[NODE_TAG_field                    ] = "field",
 	[NODE_TAG_cast                     ] = "cast",
 	[NODE_TAG_assignment               ] = "assignment",
 	[NODE_TAG_addition_assignment      ] = "addition_assignment",
@@ -1025,135 +1506,6080 @@ NOTE(Emhyr): maybe instead of repeating nodes with the same tag, encode a
 junction nodes are many.
 */
 
-/* #recursive */
+/*
+NOTE(Emhyr): the parser doesn't recurse; what's being parsed is kept on its
+stack instead, so that brackets can be nested and operations chained as much
+as a source wants without overflowing anything. a node is built once what's
+under it is, so the nodes come out in postfix order and an operation never
+has to move its left operand to put itself before it. they're put in prefix
+order once the whole expression is, in one pass.
+*/
+
+enum PARSING_STATE {
+	PARSING_STATE_operand,    /* an expression, before its first operand */
+	PARSING_STATE_operations, /* an expression, after an operand */
+	PARSING_STATE_operated,   /* an expression, after what its `tag` is over */
+	PARSING_STATE_consequent, /* an expression, after its implication's consequent */
+	PARSING_STATE_type,       /* a type, before anything */
+	PARSING_STATE_length,     /* an array, after its length */
+	PARSING_STATE_node,       /* a type or a field, after what its `tag` is over */
+	PARSING_STATE_record,     /* a record, before a field or its closing parenthesis */
+	PARSING_STATE_field,      /* a record, after a field */
+};
+
+struct PARSING {
+	enum PARSING_STATE state;
+	enum NODE_TAG tag;     /* of the node that's built over it next */
+	PRECEDENCE precedence; /* the least that an operation needs to be parsed into it */
+	SIZE data_size;        /* of the nodes before it */
+	struct RANGE range;    /* of the token that it began at */
+};
+
+/* begins parsing an expression or a type at the token. the stack only ever has these on it, so they aren't aligned or cleared */
+static inline struct PARSING *begin_parsing(enum PARSING_STATE state, PRECEDENCE precedence, SIZE data_size, struct PARSER *parser) {
+	commit_buffer(sizeof(struct PARSING), parser->stack);
+	struct PARSING *parsing = (struct PARSING *)((BYTE *)parser->stack->data + parser->stack->data_size);
+	parser->stack->data_size += sizeof(struct PARSING);
+	*parsing = (struct PARSING){ .state = state, .precedence = precedence, .data_size = data_size, .range = parser->token.range };
+	return parsing;
+}
+
+static inline struct PARSING *get_parsing(struct PARSER *parser) {
+	return (struct PARSING *)((BYTE *)parser->stack->data + parser->stack->data_size) - 1;
+}
+
+static inline VOID end_parsing(struct PARSER *parser) {
+	parser->stack->data_size -= sizeof(struct PARSING);
+}
+
+static inline struct NODE *get_last_node(C_BUFFER *buffer) {
+	return (struct NODE *)((BYTE *)buffer->data + buffer->data_size) - 1;
+}
+
+/* builds the node for `parsing`, over every node since it began */
+static struct NODE *build_node(const struct PARSING *parsing, COUNT ending, C_BUFFER *buffer) {
+	struct NODE *node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
+	node->tag = parsing->tag;
+	node->count = (buffer->data_size - parsing->data_size) / sizeof(struct NODE);
+	node->range = parsing->range;
+	node->range.ending = ending;
+	return node;
+}
+
+_Static_assert(sizeof(struct PARSING) % alignof(struct NODE) == 0, "nodes must be aligned past a parser's stack");
+
+/*
+puts nodes from postfix order into prefix order. a subtree's nodes are
+together in either, so a node's place in prefix order is where its subtree
+begins in postfix order, past its ancestors, which come before it instead of
+after it.
+*/
+static VOID order_nodes(struct NODE *nodes, COUNT nodes_count, C_BUFFER *stack) {
+	if (nodes_count < 2) return;
+	commit_buffer(nodes_count * (sizeof(struct NODE) + sizeof(COUNT)), stack);
+	struct NODE *ordered = (struct NODE *)((BYTE *)stack->data + stack->data_size);
+	COUNT *ancestors = (COUNT *)(ordered + nodes_count); /* where each one's subtree begins */
+	COUNT depth = 0;
+	for (COUNT i = nodes_count; i--;) {
+		while (depth && i < ancestors[depth - 1]) --depth;
+		COUNT beginning = i + 1 - nodes[i].count;
+		ordered[beginning + depth] = nodes[i];
+		if (nodes[i].count > 1) ancestors[depth++] = beginning;
+	}
+	copy(nodes, ordered, nodes_count * sizeof(struct NODE));
+}
+
+static inline VOID expect_token(enum TOKEN_TAG tag, const CHAR *context, struct PARSER *parser) {
+	if (parser->token.tag != tag) fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing %s", context);
+	parser->token = lex(&parser->lexer);
+}
+
+/* returns the expression's root */
 static struct NODE *parse_expression(C_BUFFER *buffer, PRECEDENCE other_precedence, struct PARSER *parser) {
-	struct RANGE beginning_range = parser->token.range;
-	SIZE beginning_data_size = buffer->data_size;
-	struct NODE *node = 0, *other_node;
-	enum NODE_TAG node_tag = unary_node_tag_from_token_tag[parser->token.tag];
-	switch (node_tag) {
-	case NODE_TAG_undefined:
-		fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing expression");
-	case NODE_TAG_nil:
-		node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
-		node->tag = NODE_TAG_nil;
-		goto finished;
-	default:
-		BOOLEAN is_literal = node_tag >= NODE_TAG_natural && node_tag <= NODE_TAG_reference;
-		if (!is_literal) parser->token = lex(&parser->lexer);
-		node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
-		node->tag = node_tag;
-		node->range = beginning_range;
-		if (is_literal)
+	SIZE beginning_data_size = buffer->data_size, beginning_stack_size = parser->stack->data_size;
+	(VOID)begin_parsing(PARSING_STATE_operand, other_precedence, beginning_data_size, parser);
+	while (parser->stack->data_size > beginning_stack_size) {
+		struct PARSING *parsing = get_parsing(parser);
+		switch (parsing->state) {
+		case PARSING_STATE_operand: {
+			enum NODE_TAG tag = unary_node_tag_from_token_tag[parser->token.tag];
+			if (tag == NODE_TAG_undefined) fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing expression");
+			if (tag == NODE_TAG_nil) {
+				struct NODE *node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
+				node->tag = NODE_TAG_nil;
+				node->count = 1;
+				end_parsing(parser);
+				break;
+			}
 			parser->token = lex(&parser->lexer);
-		else if (node_tag == NODE_TAG_indexation || node_tag == NODE_TAG_subexpression) {
-			(VOID)parse_expression(buffer, 0, parser);
-			if (parser->token.tag == (node_tag == NODE_TAG_indexation ? TOKEN_TAG_right_square_bracket : TOKEN_TAG_right_parenthesis)) {
-				node->range.ending = parser->token.range.ending;
-				parser->token = lex(&parser->lexer);
+			parsing->tag = tag;
+			if (tag >= NODE_TAG_natural && tag <= NODE_TAG_reference)
+				(VOID)build_node(parsing, parsing->range.ending, buffer);
+			else if (tag == NODE_TAG_indexation || tag == NODE_TAG_subexpression) {
+				const struct STRUCTURAL *body = parser->structure ? find_body(parsing->range.beginning, tag == NODE_TAG_indexation ? '[' : '(', parser) : 0;
+				if (body) {
+					(VOID)build_node(parsing, body->ending, buffer);
+					skip_body(body, parser);
+				} else {
+					parsing->state = PARSING_STATE_operated;
+					(VOID)begin_parsing(PARSING_STATE_operand, 0, buffer->data_size, parser);
+					break;
+				}
+			} else {
+				/* the operand is everything that the expression would've been */
+				parsing->state = PARSING_STATE_operated;
+				(VOID)begin_parsing(PARSING_STATE_operand, parsing->precedence, buffer->data_size, parser);
+				break;
 			}
-		} else {
-			other_node = parse_expression(buffer, other_precedence, parser);
-			node->range.ending = other_node->range.ending;
+			goto operations;
 		}
-		break;
-	}
-	for (;;) {
-		node_tag = binary_node_tag_from_token_tag[parser->token.tag];
-		switch (node_tag) {
-		case NODE_TAG_nil:
-			goto finished;
-		default:
-			PRECEDENCE precedence = precedence_from_node_tag[node_tag];
-			if (precedence < other_precedence) goto finished;
-			if (node_tag != NODE_TAG_invocation) parser->token = lex(&parser->lexer);
-			(VOID)push(sizeof(struct NODE), alignof(struct NODE), buffer);
-			node = buffer->data + beginning_data_size;
-			move(node + 1, node, buffer->data_size - beginning_data_size);
-			node->tag = node_tag;
-			node->range = beginning_range;
-			if (node_tag == NODE_TAG_implication) {
-				(VOID)parse_expression(buffer, 0, parser);
-				if (parser->token.tag == TOKEN_TAG_exclamation_mark) parser->token = lex(&parser->lexer);
+		case PARSING_STATE_operated: {
+			COUNT ending = get_last_node(buffer)->range.ending;
+			if (parsing->tag == NODE_TAG_indexation || parsing->tag == NODE_TAG_subexpression) {
+				ending = parsing->range.ending;
+				if (parser->token.tag == (parsing->tag == NODE_TAG_indexation ? TOKEN_TAG_right_square_bracket : TOKEN_TAG_right_parenthesis)) {
+					ending = parser->token.range.ending;
+					parser->token = lex(&parser->lexer);
+				}
+			}
+			(VOID)build_node(parsing, ending, buffer);
+		}
+		/* fallthrough */
+		case PARSING_STATE_operations:
+		operations: {
+			parsing->state = PARSING_STATE_operations;
+			enum NODE_TAG tag = binary_node_tag_from_token_tag[parser->token.tag];
+			if (tag == NODE_TAG_nil || precedence_from_node_tag[tag] < parsing->precedence) {
+				end_parsing(parser);
+				break;
+			}
+			/* an operation's right operand takes the operations that come after it with as much precedence or more */
+			PRECEDENCE precedence = precedence_from_node_tag[tag];
+			if (tag != NODE_TAG_invocation) parser->token = lex(&parser->lexer);
+			parsing->tag = tag;
+			if (tag == NODE_TAG_implication) {
+				parsing->state = PARSING_STATE_consequent;
+				(VOID)begin_parsing(PARSING_STATE_operand, 0, buffer->data_size, parser);
+			} else {
+				parsing->state = PARSING_STATE_operated;
+				(VOID)begin_parsing(tag == NODE_TAG_cast ? PARSING_STATE_type : PARSING_STATE_operand, precedence, buffer->data_size, parser);
+			}
+			break;
+		}
+		case PARSING_STATE_consequent:
+			if (parser->token.tag == TOKEN_TAG_exclamation_mark) parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_operated;
+			(VOID)begin_parsing(PARSING_STATE_operand, precedence_from_node_tag[parsing->tag], buffer->data_size, parser);
+			break;
+		case PARSING_STATE_type:
+			switch (parser->token.tag) {
+			case TOKEN_TAG_word:
+				parsing->tag = NODE_TAG_name;
+				(VOID)build_node(parsing, parsing->range.ending, buffer);
+				parser->token = lex(&parser->lexer);
+				end_parsing(parser);
+				break;
+			case TOKEN_TAG_at_sign:
+				parser->token = lex(&parser->lexer);
+				parsing->state = PARSING_STATE_node;
+				parsing->tag = NODE_TAG_pointer;
+				(VOID)begin_parsing(PARSING_STATE_type, 0, buffer->data_size, parser);
+				break;
+			case TOKEN_TAG_left_square_bracket:
+				parser->token = lex(&parser->lexer);
+				parsing->state = PARSING_STATE_length;
+				parsing->tag = NODE_TAG_array;
+				(VOID)begin_parsing(PARSING_STATE_operand, 0, buffer->data_size, parser);
+				break;
+			case TOKEN_TAG_left_parenthesis:
+				parser->token = lex(&parser->lexer);
+				parsing->state = PARSING_STATE_record;
+				parsing->tag = NODE_TAG_record;
+				break;
+			default:
+				fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing type");
+			}
+			break;
+		case PARSING_STATE_length:
+			expect_token(TOKEN_TAG_right_square_bracket, "type", parser);
+			parsing->state = PARSING_STATE_node;
+			(VOID)begin_parsing(PARSING_STATE_type, 0, buffer->data_size, parser);
+			break;
+		case PARSING_STATE_node:
+			(VOID)build_node(parsing, get_last_node(buffer)->range.ending, buffer);
+			end_parsing(parser);
+			break;
+		case PARSING_STATE_field:
+			if (parser->token.tag != TOKEN_TAG_comma) goto closed_record;
+			parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_record;
+			/* fallthrough */
+		case PARSING_STATE_record:
+			if (parser->token.tag != TOKEN_TAG_right_parenthesis) {
+				/* value-declaration: word `:` type */
+				if (parser->token.tag != TOKEN_TAG_word) fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing field");
+				parsing->state = PARSING_STATE_field;
+				begin_parsing(PARSING_STATE_node, 0, buffer->data_size, parser)->tag = NODE_TAG_field;
+				struct NODE *name = push(sizeof(struct NODE), alignof(struct NODE), buffer);
+				name->tag = NODE_TAG_name;
+				name->count = 1;
+				name->range = parser->token.range;
+				parser->token = lex(&parser->lexer);
+				expect_token(TOKEN_TAG_colon, "field", parser);
+				(VOID)begin_parsing(PARSING_STATE_type, 0, buffer->data_size, parser);
+				break;
+			}
+		closed_record:
+			(VOID)build_node(parsing, parser->token.range.ending, buffer);
+			expect_token(TOKEN_TAG_right_parenthesis, "type", parser);
+			if (parser->token.tag != TOKEN_TAG_hyphenminus_greaterthan_sign) {
+				end_parsing(parser);
+				break;
 			}
-			if (node_tag == NODE_TAG_cast) other_node = parse_type(buffer, parser);
-			else other_node = parse_expression(buffer, precedence, parser);
-			node->range.ending = other_node->range.ending;
+			parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_node;
+			parsing->tag = NODE_TAG_lambda;
+			(VOID)begin_parsing(PARSING_STATE_type, 0, buffer->data_size, parser);
 			break;
 		}
 	}
-
-finished:
-	return node;
+	struct NODE *nodes = (struct NODE *)((BYTE *)buffer->data + beginning_data_size);
+	order_nodes(nodes, (buffer->data_size - beginning_data_size) / sizeof(struct NODE), parser->stack);
+	return nodes;
 }
 
-static struct NODE *parse_type(C_BUFFER *buffer, struct PARSER *parser) {
-	struct NODE *node = 0;
-	struct RANGE range = parser->token.range;
-	switch (parser->token.tag) {
-	case TOKEN_TAG_word:
-		node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
-		node->tag = NODE_TAG_reference;
-		node->range = range;
-		node->range.ending = parser->token.range.ending;
-		parser->token = lex(&parser->lexer);
-		break;
-	case TOKEN_TAG_at_sign:
-		parser->token = lex(&parser->lexer);
-		node = push(sizeof(struct NODE), alignof(struct NODE), buffer);
-		node->tag = NODE_TAG_address;
-		node->range = range;
-		node->range.ending = parse_type(buffer, parser)->range.ending;
-		break;
-	case TOKEN_TAG_left_square_bracket:
-	case TOKEN_TAG_left_parenthesis:
-	default:
-		fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing type");
+/*
+NOTE(Emhyr): validating is parsing without building anything, for when it's
+only wanted to know whether a source parses and where it doesn't. the
+validator follows the same grammar as `parse_expression`, and fails the same
+way, but it only lexes and keeps its stack. a prefix operation's operand, and
+a pointer's type, are parsed in its place, since there's nothing to build
+once they're done. that leaves validating bound by lexing, so it's only as
+much faster as building the nodes costs.
+*/
+
+static VOID validate_expression(PRECEDENCE other_precedence, struct PARSER *parser) {
+	SIZE beginning_stack_size = parser->stack->data_size;
+	(VOID)begin_parsing(PARSING_STATE_operand, other_precedence, 0, parser);
+	while (parser->stack->data_size > beginning_stack_size) {
+		struct PARSING *parsing = get_parsing(parser);
+		switch (parsing->state) {
+		case PARSING_STATE_operand: {
+			enum NODE_TAG tag = unary_node_tag_from_token_tag[parser->token.tag];
+			if (tag == NODE_TAG_undefined) fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing expression");
+			if (tag == NODE_TAG_nil) {
+				end_parsing(parser);
+				break;
+			}
+			parser->token = lex(&parser->lexer);
+			if (tag >= NODE_TAG_natural && tag <= NODE_TAG_reference) goto operations;
+			if (tag == NODE_TAG_indexation || tag == NODE_TAG_subexpression) {
+				parsing->state = PARSING_STATE_operated;
+				parsing->tag = tag;
+				(VOID)begin_parsing(PARSING_STATE_operand, 0, 0, parser);
+			}
+			break;
+		}
+		case PARSING_STATE_operated:
+			if (parser->token.tag == (parsing->tag == NODE_TAG_indexation ? TOKEN_TAG_right_square_bracket : TOKEN_TAG_right_parenthesis))
+				parser->token = lex(&parser->lexer);
+			/* fallthrough */
+		case PARSING_STATE_operations:
+		operations: {
+			parsing->state = PARSING_STATE_operations;
+			enum NODE_TAG tag = binary_node_tag_from_token_tag[parser->token.tag];
+			if (tag == NODE_TAG_nil || precedence_from_node_tag[tag] < parsing->precedence) {
+				end_parsing(parser);
+				break;
+			}
+			PRECEDENCE precedence = precedence_from_node_tag[tag];
+			if (tag != NODE_TAG_invocation) parser->token = lex(&parser->lexer);
+			if (tag == NODE_TAG_implication) {
+				parsing->state = PARSING_STATE_consequent;
+				(VOID)begin_parsing(PARSING_STATE_operand, 0, 0, parser);
+			} else (VOID)begin_parsing(tag == NODE_TAG_cast ? PARSING_STATE_type : PARSING_STATE_operand, precedence, 0, parser);
+			break;
+		}
+		case PARSING_STATE_consequent:
+			if (parser->token.tag == TOKEN_TAG_exclamation_mark) parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_operations;
+			(VOID)begin_parsing(PARSING_STATE_operand, precedence_from_node_tag[NODE_TAG_implication], 0, parser);
+			break;
+		case PARSING_STATE_type:
+			switch (parser->token.tag) {
+			case TOKEN_TAG_word:
+				parser->token = lex(&parser->lexer);
+				end_parsing(parser);
+				break;
+			case TOKEN_TAG_at_sign:
+				parser->token = lex(&parser->lexer);
+				break;
+			case TOKEN_TAG_left_square_bracket:
+				parser->token = lex(&parser->lexer);
+				parsing->state = PARSING_STATE_length;
+				(VOID)begin_parsing(PARSING_STATE_operand, 0, 0, parser);
+				break;
+			case TOKEN_TAG_left_parenthesis:
+				parser->token = lex(&parser->lexer);
+				parsing->state = PARSING_STATE_record;
+				break;
+			default:
+				fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing type");
+			}
+			break;
+		case PARSING_STATE_length:
+			expect_token(TOKEN_TAG_right_square_bracket, "type", parser);
+			parsing->state = PARSING_STATE_type;
+			break;
+		case PARSING_STATE_field:
+			if (parser->token.tag != TOKEN_TAG_comma) goto closed_record;
+			parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_record;
+			/* fallthrough */
+		case PARSING_STATE_record:
+			if (parser->token.tag != TOKEN_TAG_right_parenthesis) {
+				if (parser->token.tag != TOKEN_TAG_word) fail(&parser->lexer.source, &parser->token.range, "unexpected token when parsing field");
+				parser->token = lex(&parser->lexer);
+				expect_token(TOKEN_TAG_colon, "field", parser);
+				parsing->state = PARSING_STATE_field;
+				(VOID)begin_parsing(PARSING_STATE_type, 0, 0, parser);
+				break;
+			}
+		closed_record:
+			expect_token(TOKEN_TAG_right_parenthesis, "type", parser);
+			if (parser->token.tag != TOKEN_TAG_hyphenminus_greaterthan_sign) {
+				end_parsing(parser);
+				break;
+			}
+			parser->token = lex(&parser->lexer);
+			parsing->state = PARSING_STATE_type;
+			break;
+		default:
+			assert(0);
+		}
 	}
-	return node;
 }
 
 /*
 NOTE(Emhyr): parsing things such as declarations aren't stored normally like an
-expression node, but rather a deticated medium for efficient lookup.
+expression node, but rather a deticated medium for efficient lookup (see
+`DECLARATIONS`).
 
 NOTE(Emhyr): even statements can
 */
 
-static struct PARSER create_parser(const CHAR *path)
+static struct PARSER create_parser(const struct SOURCE *source, const struct RANGE *range, C_BUFFER *stack)
 {
 	struct PARSER parser = {
-		.lexer = create_lexer(path),
-		.token = lex(&parser.lexer)
+		.lexer = create_lexer(source, range),
+		.token = lex(&parser.lexer),
+		.stack = stack
 	};
 	return parser;
 }
 
-static VOID dump(const struct SOURCE *source, struct NODE *nodes, SIZE nodes_count) {
-	for (SIZE i = 0; i < nodes_count; ++i) {
-		report(SEVERITY_comment, source, &nodes[i].range, "%s", string_from_node_tag[nodes[i].tag]);
-	}
-}
-
+/*
+NOTE(Emhyr): generated sources are full of literal arithmetic. the folder
+evaluates every literal, and replaces each subtree whose operands are all
+literals with a single literal. it's one pass over the prefix buffer that
+compacts it in place, since a subtree is never written past where it's read.
+a node is folded once the last node of its subtree is read, so the nodes that
+are above the one being read wait on a stack, and a tree's as deep as it
+likes without the folder recursing.
 
-int main(int argc, char *argv[]) {
-	if (argc <= 1) fail(0, 0, "a path must be given");
+only operations closed over naturals or over reals are folded; relations and
+logic produce no literal, and mixed operands are left for the checker.
+*/
 
-	const CHAR *path = argv[1];
+static BOOLEAN evaluate_natural(const struct SOURCE *source, struct NODE *node) {
+	const CHAR *digits = source->data + node->range.beginning;
+	const CHAR *ending = source->data + node->range.ending;
+	U64 base = 10;
+	if (ending - digits > 1 && digits[0] == '0') {
+		switch (digits[1]) {
+		case 'b': case 'B': base = 2;  digits += 2; break;
+		case 'x': case 'X': base = 16; digits += 2; break;
+		default:            base = 8;  digits += 1; break;
+		}
+	}
+	U64 natural = 0;
+	for (; digits < ending; ++digits) {
+		U64 digit;
+		if (*digits == '_') continue;
+		else if (*digits >= '0' && *digits <= '9') digit = *digits - '0';
+		else digit = (*digits | 0x20) - 'a' + 10;
+		if (__builtin_mul_overflow(natural, base, &natural) || __builtin_add_overflow(natural, digit, &natural)) {
+			report(SEVERITY_caution, source, &node->range, "natural exceeds 64 bits");
+			return 0;
+		}
+	}
+	node->value.natural = natural;
+	return 1;
+}
 
-	struct PARSER parser = create_parser(path);
-	struct BUFFER buffer = DEFAULT_BUFFER;
+static BOOLEAN evaluate_real(const struct SOURCE *source, struct NODE *node) {
+	/* exact when the digits fit in a double's mantissa; see Clinger's "fast path" */
+	static const F64 powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	F64 mantissa = 0, scale = 1;
+	U32 fraction_digits_count = 0;
+	BOOLEAN is_fraction = 0;
+	for (COUNT i = node->range.beginning; i < node->range.ending; ++i) {
+		CHAR digit = source->data[i];
+		if (digit == '_') continue;
+		if (digit == '.') {
+			is_fraction = 1;
+			continue;
+		}
+		mantissa = mantissa * 10 + (digit - '0');
+		if (is_fraction && ++fraction_digits_count == sizeof(powers_of_ten) / sizeof(powers_of_ten[0])) {
+			scale *= powers_of_ten[fraction_digits_count - 1];
+			fraction_digits_count = 0;
+		}
+	}
+	node->value.real = mantissa / powers_of_ten[fraction_digits_count] / scale;
+	if (__builtin_isinf(node->value.real)) {
+		report(SEVERITY_caution, source, &node->range, "real exceeds 64 bits");
+		return 0;
+	}
+	return 1;
+}
 
-	do {
-		parse_expression(&buffer, 0, &parser);
-		dump(&parser.lexer.source, buffer.data, buffer.data_size / sizeof(struct NODE));
-		buffer.data_size = 0;
-		if (parser.token.tag == TOKEN_TAG_semicolon) parser.token = lex(&parser.lexer);
-		puts("--------------------------\n");
-	} while (parser.token.tag != TOKEN_TAG_terminator);
+static BOOLEAN fold_natural_operation(const struct SOURCE *source, struct NODE *node, U64 left, U64 right) {
+	U64 result;
+	switch (node->tag) {
+	case NODE_TAG_not:            result = ~left;         break;
+	case NODE_TAG_and:            result = left & right;  break;
+	case NODE_TAG_or:             result = left | right;  break;
+	case NODE_TAG_xor:            result = left ^ right;  break;
+	case NODE_TAG_lsh:
+		if (right >= 64 || (left << right) >> right != left) goto overflowed;
+		result = left << right;
+		break;
+	case NODE_TAG_rsh:
+		if (right >= 64) goto overflowed;
+		result = left >> right;
+		break;
+	case NODE_TAG_addition:       if (__builtin_add_overflow(left, right, &result)) goto overflowed; break;
+	case NODE_TAG_subtraction:    if (__builtin_sub_overflow(left, right, &result)) goto overflowed; break;
+	case NODE_TAG_multiplication: if (__builtin_mul_overflow(left, right, &result)) goto overflowed; break;
+	case NODE_TAG_division:
+	case NODE_TAG_remainder:
+		if (!right) {
+			report(SEVERITY_caution, source, &node->range, "division by zero");
+			return 0;
+		}
+		result = node->tag == NODE_TAG_division ? left / right : left % right;
+		break;
+	case NODE_TAG_subexpression:  result = left;          break;
+	default:
+		return 0;
+	}
+	node->tag = NODE_TAG_natural;
+	node->value.natural = result;
+	return 1;
+overflowed:
+	report(SEVERITY_caution, source, &node->range, "%s overflows 64 bits", string_from_node_tag[node->tag]);
+	return 0;
+}
 
-	
-	
+static BOOLEAN fold_real_operation(const struct SOURCE *source, struct NODE *node, F64 left, F64 right) {
+	F64 result;
+	switch (node->tag) {
+	case NODE_TAG_negative:       result = -left;         break;
+	case NODE_TAG_addition:       result = left + right;  break;
+	case NODE_TAG_subtraction:    result = left - right;  break;
+	case NODE_TAG_multiplication: result = left * right;  break;
+	case NODE_TAG_division:
+		if (right == 0) {
+			report(SEVERITY_caution, source, &node->range, "division by zero");
+			return 0;
+		}
+		result = left / right;
+		break;
+	case NODE_TAG_subexpression:  result = left;          break;
+	default:
+		return 0;
+	}
+	if (__builtin_isinf(result)) {
+		report(SEVERITY_caution, source, &node->range, "%s overflows", string_from_node_tag[node->tag]);
+		return 0;
+	}
+	node->tag = NODE_TAG_real;
+	node->value.real = result;
+	return 1;
+}
+
+/* a node whose operands are being folded */
+struct FOLDING {
+	struct NODE folded;   /* as it was read, until it's written */
+	COUNT destination;    /* where it's written */
+	COUNT ending;         /* of its subtree, where it was read */
+	COUNT operands[2];    /* where its first operands were written */
+	COUNT operands_count;
+	BOOLEAN are_operands_constant;
+};
+
+/* returns how many nodes are left */
+static COUNT fold_constants(const struct SOURCE *source, struct NODE *nodes, COUNT nodes_count, C_BUFFER *stack) {
+	SIZE beginning_stack_size = stack->data_size;
+	COUNT written_count = 0;
+	for (COUNT read_count = 0; read_count < nodes_count;) {
+		struct FOLDING *folding = push(sizeof(struct FOLDING), alignof(struct FOLDING), stack);
+		folding->folded = nodes[read_count];
+		folding->destination = written_count++;
+		folding->ending = read_count + folding->folded.count;
+		folding->are_operands_constant = 1;
+		++read_count;
+
+		/* each subtree that ends here is folded, from the innermost out */
+		while (stack->data_size > beginning_stack_size && (folding = (struct FOLDING *)((BYTE *)stack->data + stack->data_size) - 1)->ending == read_count) {
+			struct NODE folded = folding->folded;
+			BOOLEAN is_constant = 0;
+			if (folded.tag == NODE_TAG_natural) is_constant = evaluate_natural(source, &folded);
+			else if (folded.tag == NODE_TAG_real) is_constant = evaluate_real(source, &folded);
+			else {
+				folded.count = written_count - folding->destination;
+				const struct NODE *operands[2] = { &nodes[folding->operands[0]], &nodes[folding->operands[1]] };
+				COUNT operands_count = folding->operands_count;
+				if (folding->are_operands_constant && operands_count && operands_count <= 2 && (operands_count == 1 || operands[0]->tag == operands[1]->tag)) {
+					union VALUE left = operands[0]->value, right = operands_count == 2 ? operands[1]->value : (union VALUE){ 0 };
+					if (operands[0]->tag == NODE_TAG_natural ? fold_natural_operation(source, &folded, left.natural, right.natural) : fold_real_operation(source, &folded, left.real, right.real)) {
+						folded.count = 1;
+						is_constant = 1;
+						written_count = folding->destination + 1;
+					}
+				}
+			}
+			COUNT destination = folding->destination;
+			nodes[destination] = folded;
+			stack->data_size -= sizeof(struct FOLDING);
+			if (stack->data_size == beginning_stack_size) break;
+
+			struct FOLDING *parent = folding - 1;
+			if (parent->operands_count < 2) parent->operands[parent->operands_count] = destination;
+			++parent->operands_count;
+			parent->are_operands_constant &= is_constant;
+		}
+	}
+	return written_count;
+}
+
+/*
+NOTE(Emhyr): hash-consing stores every structurally distinct subtree once, in a
+DAG whose nodes refer to their operands by index. identity is its tag, its
+operands, and its literal value or name, but not its range. so, two subtrees
+are equal exactly when their indices are.
+*/
+
+#define MAXIMUM_OPERANDS_COUNT 3
+
+struct DAG_NODE {
+	enum NODE_TAG tag;
+	COUNT operands_count;
+	COUNT operands[MAXIMUM_OPERANDS_COUNT];
+	union VALUE value;
+	U64 hash;
+	struct RANGE range; /* of its first occurrence */
+};
+
+struct DAG {
+	struct BUFFER nodes;
+	COUNT nodes_count;
+	COUNT *slots; /* 0 is no node, otherwise its index plus 1 */
+	COUNT slots_count;
+	SIZE uses_count;
+	struct INTERNER *interner;
+};
+
+static BOOLEAN are_dag_nodes_equal(const struct DAG_NODE *left, const struct DAG_NODE *right) {
+	if (left->hash != right->hash || left->tag != right->tag || left->operands_count != right->operands_count) return 0;
+	for (COUNT i = 0; i < left->operands_count; ++i)
+		if (left->operands[i] != right->operands[i]) return 0;
+	switch (left->tag) {
+	case NODE_TAG_natural: return left->value.natural == right->value.natural;
+	case NODE_TAG_real:    return !__builtin_memcmp(&left->value.real, &right->value.real, sizeof(F64));
+	case NODE_TAG_string:
+	case NODE_TAG_reference:
+		return left->value.symbol == right->value.symbol;
+	case NODE_TAG_cast:
+		return left->value.type == right->value.type;
+	default:
+		return 1;
+	}
+}
+
+static COUNT share_dag_node(const struct DAG_NODE *key, struct DAG *dag) {
+	if (dag->nodes_count * 2 >= dag->slots_count) {
+		COUNT slots_count = dag->slots_count ? dag->slots_count * 2 : 1024;
+		COUNT *slots = allocate_virtual_memory(slots_count * sizeof(COUNT));
+		for (COUNT j = 0; j < dag->nodes_count; ++j) {
+			COUNT i = ((struct DAG_NODE *)dag->nodes.data)[j].hash & (slots_count - 1);
+			while (slots[i]) i = (i + 1) & (slots_count - 1);
+			slots[i] = j + 1;
+		}
+		if (dag->slots) release_virtual_memory(dag->slots, dag->slots_count * sizeof(COUNT));
+		dag->slots = slots;
+		dag->slots_count = slots_count;
+	}
+
+	++dag->uses_count;
+	COUNT i = key->hash & (dag->slots_count - 1);
+	for (; dag->slots[i]; i = (i + 1) & (dag->slots_count - 1))
+		if (are_dag_nodes_equal((struct DAG_NODE *)dag->nodes.data + dag->slots[i] - 1, key))
+			return dag->slots[i] - 1;
+
+	*(struct DAG_NODE *)push(sizeof(struct DAG_NODE), alignof(struct DAG_NODE), &dag->nodes) = *key;
+	dag->slots[i] = ++dag->nodes_count;
+	return dag->nodes_count - 1;
+}
+
+/* #recursive */
+static COUNT share_subtree(const struct NODE *node, const struct SOURCE *source, struct DAG *dag) {
+	struct DAG_NODE key = { .tag = node->tag, .range = node->range };
+	U64 hash = mix_hash(0, node->tag);
+	switch (node->tag) {
+	case NODE_TAG_natural:
+	case NODE_TAG_real:
+		key.value = node->value;
+		hash = mix_hash(hash, node->value.natural);
+		break;
+	case NODE_TAG_string:
+	case NODE_TAG_reference:
+		key.value.symbol = intern(source->data + node->range.beginning, node->range.ending - node->range.beginning, dag->interner);
+		hash = mix_hash(hash, key.value.symbol);
+		break;
+	case NODE_TAG_cast:
+		/* the type is already interned */
+		key.operands[key.operands_count++] = share_subtree(get_first_child(node), source, dag);
+		key.value.type = node->value.type;
+		hash = mix_hash(mix_hash(hash, key.operands[0]), key.value.type);
+		break;
+	default:
+		for (struct NODE *child = get_first_child(node); child; child = get_next_sibling(child, node)) {
+			assert(key.operands_count < MAXIMUM_OPERANDS_COUNT);
+			COUNT operand = share_subtree(child, source, dag);
+			key.operands[key.operands_count++] = operand;
+			hash = mix_hash(hash, operand);
+		}
+		break;
+	}
+	key.hash = hash;
+	return share_dag_node(&key, dag);
+}
+
+/*
+NOTE(Emhyr): every distinct type is interned once, so types are equal exactly
+when their indices are. a type is its tag and its operands:
+
+- name: the name.
+- pointer: the type pointed to.
+- array: the hash-consed length expression, and the element type.
+- record: the name and type of each field.
+- lambda: the record of parameters, and the returned type.
+
+the index is stored in the value of each type node, and of each cast.
+*/
+
+struct INTERNED_TYPE {
+	enum NODE_TAG tag;
+	COUNT operands_count;
+	SIZE operands_offset; /* into `operands` */
+	U64 hash;
+};
+
+struct TYPES {
+	struct BUFFER types;
+	struct BUFFER operands;
+	COUNT types_count;
+	TYPE *slots;
+	COUNT slots_count;
+	struct DAG lengths;
+	struct INTERNER *interner;
+};
+
+static inline const COUNT *get_type_operands(TYPE type, const struct TYPES *types) {
+	return (const COUNT *)((BYTE *)types->operands.data + ((struct INTERNED_TYPE *)types->types.data)[type].operands_offset);
+}
+
+static inline SYMBOL intern_range(const struct RANGE *range, const struct SOURCE *source, struct INTERNER *interner) {
+	return intern(source->data + range->beginning, range->ending - range->beginning, interner);
+}
+
+static inline VOID push_type_operand(COUNT operand, struct TYPES *types) {
+	*(COUNT *)push(sizeof(COUNT), alignof(COUNT), &types->operands) = operand;
+}
+
+/* #recursive */
+static TYPE intern_type(struct NODE *node, const struct SOURCE *source, struct TYPES *types) {
+	if (types->types_count * 2 + 2 >= types->slots_count) {
+		COUNT slots_count = types->slots_count ? types->slots_count * 2 : 1024;
+		TYPE *slots = allocate_virtual_memory(slots_count * sizeof(TYPE));
+		for (TYPE type = 1; type <= types->types_count; ++type) {
+			COUNT i = ((struct INTERNED_TYPE *)types->types.data)[type].hash & (slots_count - 1);
+			while (slots[i]) i = (i + 1) & (slots_count - 1);
+			slots[i] = type;
+		}
+		if (types->slots) release_virtual_memory(types->slots, types->slots_count * sizeof(TYPE));
+		types->slots = slots;
+		types->slots_count = slots_count;
+		if (!types->types_count) (VOID)push(sizeof(struct INTERNED_TYPE), alignof(struct INTERNED_TYPE), &types->types);
+	}
+
+	/* the operands are interned first, so that theirs aren't interleaved with these */
+	struct NODE *child, *grandchild;
+	for (child = get_first_child(node); child; child = get_next_sibling(child, node)) {
+		switch (child->tag) {
+		case NODE_TAG_field:
+			grandchild = get_next_sibling(get_first_child(child), child);
+			grandchild->value.type = intern_type(grandchild, source, types);
+			break;
+		case NODE_TAG_name:
+		case NODE_TAG_pointer:
+		case NODE_TAG_array:
+		case NODE_TAG_record:
+		case NODE_TAG_lambda:
+			if (node->tag != NODE_TAG_array || child != get_first_child(node)) child->value.type = intern_type(child, source, types);
+			break;
+		default:
+			break;
+		}
+	}
+
+	SIZE operands_offset = types->operands.data_size;
+	switch (node->tag) {
+	case NODE_TAG_name:
+		push_type_operand(intern_range(&node->range, source, types->interner), types);
+		break;
+	case NODE_TAG_array:
+		child = get_first_child(node);
+		push_type_operand(share_subtree(child, source, &types->lengths), types);
+		push_type_operand(get_next_sibling(child, node)->value.type, types);
+		break;
+	case NODE_TAG_record:
+		for (child = get_first_child(node); child; child = get_next_sibling(child, node)) {
+			grandchild = get_first_child(child);
+			push_type_operand(intern_range(&grandchild->range, source, types->interner), types);
+			push_type_operand(get_next_sibling(grandchild, child)->value.type, types);
+		}
+		break;
+	default:
+		for (child = get_first_child(node); child; child = get_next_sibling(child, node))
+			push_type_operand(child->value.type, types);
+		break;
+	}
+
+	COUNT operands_count = (types->operands.data_size - operands_offset) / sizeof(COUNT);
+	const COUNT *operands = (const COUNT *)((BYTE *)types->operands.data + operands_offset);
+	U64 hash = mix_hash(0, node->tag);
+	for (COUNT i = 0; i < operands_count; ++i)
+		hash = mix_hash(hash, operands[i]);
+
+	COUNT i = hash & (types->slots_count - 1);
+	for (TYPE type; (type = types->slots[i]); i = (i + 1) & (types->slots_count - 1)) {
+		const struct INTERNED_TYPE *interned = (const struct INTERNED_TYPE *)types->types.data + type;
+		if (interned->hash == hash && interned->tag == node->tag && interned->operands_count == operands_count
+			&& !__builtin_memcmp(get_type_operands(type, types), operands, operands_count * sizeof(COUNT))) {
+			types->operands.data_size = operands_offset;
+			return node->value.type = type;
+		}
+	}
+
+	*(struct INTERNED_TYPE *)push(sizeof(struct INTERNED_TYPE), alignof(struct INTERNED_TYPE), &types->types) = (struct INTERNED_TYPE){
+		.tag             = node->tag,
+		.operands_count  = operands_count,
+		.operands_offset = operands_offset,
+		.hash            = hash,
+	};
+	return node->value.type = types->slots[i] = ++types->types_count;
+}
+
+static VOID intern_types(struct NODE *nodes, COUNT nodes_count, const struct SOURCE *source, struct TYPES *types) {
+	for (struct NODE *node = nodes; node < nodes + nodes_count; ++node) {
+		if (node->tag != NODE_TAG_cast) continue;
+		struct NODE *type = get_next_sibling(get_first_child(node), node);
+		node->value.type = intern_type(type, source, types);
+	}
+}
+
+/*
+NOTE(Emhyr): declarations aren't found by walking the nodes of prior
+statements. instead, each is put in a dense table, and a single open-addressed
+map goes from a scope and a name to the declaration. a scope is only its
+parent, so a name is resolved by probing once for each scope in the chain.
+
+scope 0 is the global scope, and each record type has a scope of its fields,
+whose parent is the global one. a statement declares when it's
+`word : type` or `word : type = expression`.
+*/
+
+struct DECLARATION {
+	SYMBOL name;
+	TYPE type;
+	COUNT scope;
+	struct NODE *node;  /* the cast */
+	struct NODE *value; /* 0 when uninitialized */
+	COUNT waiters;      /* the statements waiting for it to be checked */
+};
+
+struct DECLARATIONS {
+	struct BUFFER declarations; /* 0 is never a declaration */
+	COUNT declarations_count;
+	struct BUFFER scopes; /* the parent of each scope */
+	COUNT scopes_count;
+	struct BUFFER scope_from_type; /* 0 unless it's a record */
+	COUNT *slots;
+	COUNT slots_count;
+	struct INTERNER *interner;
+};
+
+static inline struct DECLARATION *get_declaration(COUNT declaration, const struct DECLARATIONS *declarations) {
+	return (struct DECLARATION *)declarations->declarations.data + declaration;
+}
+
+static inline U64 hash_declaration(SYMBOL name, COUNT scope) {
+	return mix_hash(mix_hash(0, scope), name);
+}
+
+static COUNT *find_declaration_slot(SYMBOL name, COUNT scope, const struct DECLARATIONS *declarations) {
+	COUNT i = hash_declaration(name, scope) & (declarations->slots_count - 1);
+	for (COUNT *slot; *(slot = &declarations->slots[i]); i = (i + 1) & (declarations->slots_count - 1)) {
+		const struct DECLARATION *declaration = get_declaration(*slot, declarations);
+		if (declaration->name == name && declaration->scope == scope) return slot;
+	}
+	return &declarations->slots[i];
+}
+
+static COUNT find_declaration(SYMBOL name, COUNT scope, const struct DECLARATIONS *declarations) {
+	if (!declarations->slots) return 0;
+	for (;;) {
+		COUNT declaration = *find_declaration_slot(name, scope, declarations);
+		if (declaration || !scope) return declaration;
+		scope = ((COUNT *)declarations->scopes.data)[scope];
+	}
+}
+
+static COUNT declare(struct NODE *node, TYPE type, COUNT scope, struct NODE *value, const struct SOURCE *source, struct DECLARATIONS *declarations) {
+	if (declarations->declarations_count * 2 + 2 >= declarations->slots_count) {
+		COUNT slots_count = declarations->slots_count ? declarations->slots_count * 2 : 1024;
+		COUNT *slots = allocate_virtual_memory(slots_count * sizeof(COUNT));
+		for (COUNT declaration = 1; declaration <= declarations->declarations_count; ++declaration) {
+			const struct DECLARATION *declared = get_declaration(declaration, declarations);
+			COUNT i = hash_declaration(declared->name, declared->scope) & (slots_count - 1);
+			while (slots[i]) i = (i + 1) & (slots_count - 1);
+			slots[i] = declaration;
+		}
+		if (declarations->slots) release_virtual_memory(declarations->slots, declarations->slots_count * sizeof(COUNT));
+		declarations->slots = slots;
+		declarations->slots_count = slots_count;
+		if (!declarations->declarations_count) (VOID)push(sizeof(struct DECLARATION), alignof(struct DECLARATION), &declarations->declarations);
+	}
+
+	struct NODE *name = get_first_child(node);
+	SYMBOL symbol = intern_range(&name->range, source, declarations->interner);
+	COUNT *slot = find_declaration_slot(symbol, scope, declarations);
+	if (*slot) fail(source, &name->range, "redeclaration of `%.*s`", name->range.ending - name->range.beginning, source->data + name->range.beginning);
+
+	*(struct DECLARATION *)push(sizeof(struct DECLARATION), alignof(struct DECLARATION), &declarations->declarations) = (struct DECLARATION){
+		.name  = symbol,
+		.type  = type,
+		.scope = scope,
+		.node  = node,
+		.value = value,
+	};
+	return *slot = ++declarations->declarations_count;
+}
+
+static COUNT get_record_scope(TYPE type, const struct DECLARATIONS *declarations) {
+	if (type * sizeof(COUNT) >= declarations->scope_from_type.data_size) return 0;
+	return ((COUNT *)declarations->scope_from_type.data)[type];
+}
+
+/* #recursive */
+static VOID declare_fields(struct NODE *type, const struct SOURCE *source, struct DECLARATIONS *declarations) {
+	for (struct NODE *child = get_first_child(type); child; child = get_next_sibling(child, type))
+		declare_fields(child, source, declarations);
+	if (type->tag != NODE_TAG_record || get_record_scope(type->value.type, declarations)) return;
+
+	if (!declarations->scopes_count) (VOID)push(sizeof(COUNT), alignof(COUNT), &declarations->scopes);
+	COUNT scope = ++declarations->scopes_count;
+	*(COUNT *)push(sizeof(COUNT), alignof(COUNT), &declarations->scopes) = 0;
+	while (type->value.type * sizeof(COUNT) >= declarations->scope_from_type.data_size)
+		(VOID)push(sizeof(COUNT), alignof(COUNT), &declarations->scope_from_type);
+	((COUNT *)declarations->scope_from_type.data)[type->value.type] = scope;
+
+	for (struct NODE *field = get_first_child(type); field; field = get_next_sibling(field, type))
+		(VOID)declare(field, get_next_sibling(get_first_child(field), field)->value.type, scope, 0, source, declarations);
+}
+
+static COUNT declare_statement(struct NODE *nodes, COUNT nodes_count, const struct SOURCE *source, struct DECLARATIONS *declarations) {
+	if (!nodes_count) return 0;
+	struct NODE *node = nodes, *value = 0;
+	if (node->tag == NODE_TAG_assignment) {
+		node = get_first_child(node);
+		value = get_next_sibling(node, nodes);
+	}
+	if (node->tag != NODE_TAG_cast || get_first_child(node)->tag != NODE_TAG_reference) return 0;
+	struct NODE *type = get_next_sibling(get_first_child(node), node);
+	declare_fields(type, source, declarations);
+	return declare(node, node->value.type, 0, value, source, declarations);
+}
+
+/*
+NOTE(Emhyr): the field of a resolution is only resolved here when the operand
+is a reference to a record; everything else is left for the checker, as are
+unresolved references.
+*/
+
+/* #recursive */
+static VOID resolve_subtree(struct NODE *node, const struct SOURCE *source, struct DECLARATIONS *declarations) {
+	struct NODE *child = get_first_child(node), *other_child;
+	switch (node->tag) {
+	case NODE_TAG_reference:
+		node->value.declaration = find_declaration(intern_range(&node->range, source, declarations->interner), 0, declarations);
+		break;
+	case NODE_TAG_array:
+		resolve_subtree(child, source, declarations);
+		resolve_subtree(get_next_sibling(child, node), source, declarations);
+		break;
+	case NODE_TAG_field:
+		resolve_subtree(get_next_sibling(child, node), source, declarations);
+		break;
+	case NODE_TAG_resolution:
+		resolve_subtree(child, source, declarations);
+		other_child = get_next_sibling(child, node);
+		if (child->tag == NODE_TAG_reference && child->value.declaration && other_child->tag == NODE_TAG_reference) {
+			COUNT scope = get_record_scope(get_declaration(child->value.declaration, declarations)->type, declarations);
+			SYMBOL name = intern_range(&other_child->range, source, declarations->interner);
+			if (scope) other_child->value.declaration = *find_declaration_slot(name, scope, declarations);
+		} else resolve_subtree(other_child, source, declarations);
+		break;
+	case NODE_TAG_name:
+		break;
+	default:
+		for (; child; child = get_next_sibling(child, node))
+			resolve_subtree(child, source, declarations);
+		break;
+	}
+}
+
+static VOID resolve_references(struct NODE *nodes, COUNT nodes_count, const struct SOURCE *source, struct DECLARATIONS *declarations) {
+	if (nodes_count) resolve_subtree(nodes, source, declarations);
+}
+
+static VOID dump(const struct SOURCE *source, struct NODE *nodes, SIZE nodes_count) {
+	for (SIZE i = 0; i < nodes_count; ++i) {
+		switch (nodes[i].tag) {
+		case NODE_TAG_natural:
+			report(SEVERITY_comment, source, &nodes[i].range, "%s %llu", string_from_node_tag[nodes[i].tag], nodes[i].value.natural);
+			break;
+		case NODE_TAG_real:
+			report(SEVERITY_comment, source, &nodes[i].range, "%s %g", string_from_node_tag[nodes[i].tag], nodes[i].value.real);
+			break;
+		case NODE_TAG_cast:
+			report(SEVERITY_comment, source, &nodes[i].range, "%s to type %u", string_from_node_tag[nodes[i].tag], nodes[i].value.type);
+			break;
+		case NODE_TAG_reference:
+			if (nodes[i].value.declaration) report(SEVERITY_comment, source, &nodes[i].range, "%s to declaration %u", string_from_node_tag[nodes[i].tag], nodes[i].value.declaration);
+			else report(SEVERITY_comment, source, &nodes[i].range, "%s", string_from_node_tag[nodes[i].tag]);
+			break;
+		default:
+			report(SEVERITY_comment, source, &nodes[i].range, "%s", string_from_node_tag[nodes[i].tag]);
+			break;
+		}
+	}
+}
+
+/*
+NOTE(Emhyr): a file is a sequence of `;`-terminated statements, and none of
+them depend on another syntactically. so, a pre-scan splits the source at every
+top-level `;` (ignoring those within brackets or strings), and the statements
+are parsed by a pool of workers, each into its own buffer.
+*/
+
+struct DIAGNOSTIC;
+
+struct STATEMENT {
+	struct RANGE range;
+	struct NODE *nodes;
+	COUNT nodes_count;
+	COUNT dag_node;    /* when hash-consed */
+	COUNT declaration; /* that it declares */
+	COUNT next_waiter; /* when suspended by the checker */
+	COUNT cycle;       /* of references, when the checker finds it in one */
+	struct DIAGNOSTIC *diagnostics;
+	COUNT diagnostics_count;
+};
+
+/* sixteen bytes at a time; this lowers to SSE2 on x86-64 */
+typedef BYTE VECTOR       __attribute__((vector_size(16)));
+typedef U64  VECTOR_WORDS __attribute__((vector_size(16)));
+
+static inline VECTOR splat(BYTE byte) {
+	return (VECTOR){ 0 } + byte;
+}
+
+static inline BOOLEAN is_zero_vector(VECTOR vector) {
+	VECTOR_WORDS words = (VECTOR_WORDS)vector;
+	return !(words[0] | words[1]);
+}
+
+static inline COUNT count_bytes_in_vector(VECTOR vector, BYTE byte) {
+	VECTOR_WORDS words = (VECTOR_WORDS)(VECTOR)(vector == splat(byte));
+	return (__builtin_popcountll(words[0]) + __builtin_popcountll(words[1])) / 8;
+}
+
+/* the scanner is resumable, so that a stream is scanned as it's read */
+struct SCANNER {
+	COUNT position;
+	COUNT row;
+	COUNT depth;
+	COUNT beginning; /* of the statement that's being scanned */
+	COUNT beginning_row;
+	COUNT floor;        /* what's before it may be gone */
+	COUNT floor_column; /* of `floor`, were it on its row */
+	BOOLEAN is_in_string;
+	BOOLEAN is_escaped;
+};
+
+#define DEFAULT_SCANNER (struct SCANNER){ .row = 1, .beginning_row = 1, .floor_column = 1 }
+
+/*
+forgets what's before `floor`, which mustn't be past the statement that's being
+scanned. its column is found from it backwards, up to its row's beginning or
+the old floor, whichever's first, so each byte is looked at once at most.
+*/
+static VOID raise_floor(COUNT floor, struct SCANNER *scanner, const struct SOURCE *source) {
+	/* the lexer counts columns by bytes, continuation bytes included, so they're counted here too */
+	COUNT position = floor;
+	while (position > scanner->floor && source->data[position - 1] != '\n') --position;
+	COUNT column = floor - position + 1;
+	if (position == scanner->floor) column += scanner->floor_column - 1;
+	scanner->floor = floor;
+	scanner->floor_column = column;
+}
+
+/* the floor is raised to each statement that's pushed, so that a row with many statements isn't scanned back over for each */
+static VOID push_statement(COUNT beginning, COUNT ending, COUNT row, struct SCANNER *scanner, const struct SOURCE *source, C_BUFFER *statements) {
+	raise_floor(beginning, scanner, source);
+	struct STATEMENT *statement = push(sizeof(struct STATEMENT), alignof(struct STATEMENT), statements);
+	statement->range = (struct RANGE){ .beginning = beginning, .ending = ending, .row = row, .column = scanner->floor_column };
+}
+
+/* scans up to `source->size`, but the statement that's left is only pushed by `finish_scanning` */
+static COUNT resume_scanning(struct SCANNER *scanner, const struct SOURCE *source, C_BUFFER *statements) {
+	const BYTE *data = (const BYTE *)source->data;
+	COUNT statements_count = 0;
+	COUNT beginning = scanner->beginning, beginning_row = scanner->beginning_row;
+	COUNT row = scanner->row, depth = scanner->depth;
+	BOOLEAN is_in_string = scanner->is_in_string, is_escaped = scanner->is_escaped;
+	COUNT position = scanner->position;
+	while (position < source->size) {
+		COUNT chunk_ending = position + sizeof(VECTOR);
+		if (chunk_ending <= source->size) {
+			VECTOR bytes;
+			copy(&bytes, data + position, sizeof(VECTOR));
+			VECTOR structurals = (VECTOR)(
+				(bytes == splat(';')) | (bytes == splat('"')) | (bytes == splat('\\')) |
+				(bytes == splat('(')) | (bytes == splat(')')) |
+				(bytes == splat('[')) | (bytes == splat(']')) |
+				(bytes == splat('{')) | (bytes == splat('}')));
+			if (is_zero_vector(structurals)) {
+				/* an escaped byte that isn't structural doesn't matter */
+				is_escaped = 0;
+				row += count_bytes_in_vector(bytes, '\n');
+				position = chunk_ending;
+				continue;
+			}
+		} else chunk_ending = source->size;
+
+		for (; position < chunk_ending; ++position) {
+			BYTE byte = data[position];
+			if (byte == '\n') ++row;
+			if (is_in_string) {
+				if (is_escaped) is_escaped = 0;
+				else if (byte == '\\') is_escaped = 1;
+				else if (byte == '"') is_in_string = 0;
+			} else switch (byte) {
+			case '"':
+				is_in_string = 1;
+				break;
+			case '(': case '[': case '{':
+				++depth;
+				break;
+			case ')': case ']': case '}':
+				if (depth) --depth;
+				break;
+			case ';':
+				if (depth) break;
+				push_statement(beginning, position + 1, beginning_row, scanner, source, statements);
+				++statements_count;
+				beginning = position + 1;
+				beginning_row = row;
+				break;
+			}
+		}
+	}
+
+	scanner->position = position;
+	scanner->row = row;
+	scanner->depth = depth;
+	scanner->beginning = beginning;
+	scanner->beginning_row = beginning_row;
+	scanner->is_in_string = is_in_string;
+	scanner->is_escaped = is_escaped;
+	return statements_count;
+}
+
+/* pushes the statement that's left, unless it's only whitespace */
+static COUNT finish_scanning(struct SCANNER *scanner, const struct SOURCE *source, C_BUFFER *statements) {
+	for (COUNT position = scanner->beginning; position < source->size; ++position) {
+		BYTE byte = source->data[position];
+		if (byte != ' ' && (byte < '\t' || byte > '\r')) {
+			push_statement(scanner->beginning, source->size, scanner->beginning_row, scanner, source, statements);
+			scanner->beginning = source->size;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static COUNT scan_statements(const struct SOURCE *source, C_BUFFER *statements) {
+	struct SCANNER scanner = DEFAULT_SCANNER;
+	COUNT statements_count = resume_scanning(&scanner, source, statements);
+	return statements_count + finish_scanning(&scanner, source, statements);
+}
+
+/* a bit for each byte that's set, from the top bit of each */
+static inline U64 get_vector_mask(VECTOR vector) {
+	VECTOR_WORDS words = (VECTOR_WORDS)vector;
+	return (words[0] & 0x8080808080808080) * 0x0002040810204081 >> 56
+	     | (words[1] & 0x8080808080808080) * 0x0002040810204081 >> 56 << 8;
+}
+
+static inline U64 get_low_bits(COUNT count) {
+	return count < 64 ? ((U64)1 << count) - 1 : (U64)-1;
+}
+
+/*
+the structure's found 64 bytes at a time: a bitmask of each kind of byte that
+matters is made for the block, and only the brackets, quotes and backslashes
+in it are gone through, by their bits. newlines are only counted, for the
+rows and columns of where bodies end; the lexer counts columns by bytes,
+since it decodes a multibyte sequence a byte at a time.
+*/
+static struct STRUCTURE index_structure(const struct SOURCE *source, C_BUFFER *buffer) {
+	enum { BLOCK_SIZE = 64 };
+	struct STRUCTURE structure = { .structurals = push(0, alignof(struct STRUCTURAL), buffer) };
+	struct BUFFER openings = DEFAULT_BUFFER; /* of the brackets that are open */
+	COUNT *open_structurals = push(0, alignof(COUNT), &openings);
+	COUNT openings_count = 0, string = 0;
+	BOOLEAN is_in_string = 0;
+	COUNT escaped_position = -1;
+	COUNT row = 1, line_beginning = 0;
+	for (COUNT base = 0; base < source->size; base += BLOCK_SIZE) {
+		BYTE block[BLOCK_SIZE];
+		if (base + BLOCK_SIZE <= source->size) copy(block, source->data + base, BLOCK_SIZE);
+		else {
+			fill(block, 0, BLOCK_SIZE);
+			copy(block, source->data + base, source->size - base);
+		}
+		/* a block can't open more than its size, so that's committed once for it */
+		commit_buffer(BLOCK_SIZE * sizeof(struct STRUCTURAL), buffer);
+		commit_buffer(BLOCK_SIZE * sizeof(COUNT), &openings);
+		U64 quotes = 0, backslashes = 0, brackets = 0, newlines = 0;
+		for (COUNT i = 0; i < BLOCK_SIZE; i += sizeof(VECTOR)) {
+			VECTOR bytes;
+			copy(&bytes, block + i, sizeof(VECTOR));
+			quotes        |= get_vector_mask((VECTOR)(bytes == splat('"'))) << i;
+			backslashes   |= get_vector_mask((VECTOR)(bytes == splat('\\'))) << i;
+			brackets      |= get_vector_mask((VECTOR)(
+				(bytes == splat('(')) | (bytes == splat(')')) |
+				(bytes == splat('[')) | (bytes == splat(']')) |
+				(bytes == splat('{')) | (bytes == splat('}')))) << i;
+			newlines      |= get_vector_mask((VECTOR)(bytes == splat('\n'))) << i;
+		}
+
+		for (U64 bits = quotes | backslashes | brackets; bits; bits &= bits - 1) {
+			COUNT bit = __builtin_ctzll(bits), position = base + bit;
+			BYTE byte = block[bit];
+			if (position == escaped_position) continue;
+			if (is_in_string) {
+				if (byte == '\\') escaped_position = position + 1;
+				else if (byte != '"') continue;
+				else is_in_string = 0;
+			} else if (byte == '"') is_in_string = 1;
+			else if (byte == '\\') continue;
+
+			BOOLEAN is_opening = byte == '(' || byte == '[' || byte == '{' || byte == '"' && is_in_string;
+			if (is_opening) {
+				structure.structurals[structure.structurals_count] = (struct STRUCTURAL){ .beginning = position, .opening = byte };
+				if (byte == '"') string = structure.structurals_count;
+				else {
+					open_structurals[openings_count++] = structure.structurals_count;
+					openings.data_size += sizeof(COUNT);
+				}
+				buffer->data_size += sizeof(struct STRUCTURAL);
+				++structure.structurals_count;
+				continue;
+			}
+
+			struct STRUCTURAL *structural;
+			if (byte == '"') structural = &structure.structurals[string];
+			else {
+				if (!openings_count) continue;
+				structural = &structure.structurals[open_structurals[openings_count - 1]];
+				if (structural->opening != (byte == ')' ? '(' : byte == ']' ? '[' : '{')) continue;
+				--openings_count;
+				openings.data_size -= sizeof(COUNT);
+			}
+			U64 line_newlines = newlines & get_low_bits(bit);
+			COUNT beginning = line_newlines ? base + 63 - __builtin_clzll(line_newlines) + 1 : line_beginning;
+			structural->ending = position + 1;
+			structural->ending_row = row + __builtin_popcountll(line_newlines);
+			structural->ending_column = position + 1 - beginning + 1;
+			structural->next = structure.structurals_count;
+		}
+
+		if (newlines) line_beginning = base + 63 - __builtin_clzll(newlines) + 1;
+		row += __builtin_popcountll(newlines);
+	}
+	if (openings.data) release_virtual_memory(openings.data, openings.reservation_size);
+	return structure;
+}
+
+/* the first structural that's at `position` or past it */
+static COUNT find_structural(COUNT position, const struct STRUCTURE *structure) {
+	COUNT low = 0, high = structure->structurals_count;
+	while (low < high) {
+		COUNT middle = low + (high - low) / 2;
+		if (structure->structurals[middle].beginning < position) low = middle + 1;
+		else high = middle;
+	}
+	return low;
+}
+
+/*
+parses the deferred body at `index` in a statement, though not the bodies
+within it, and splices it in. the statement's nodes are copied into `buffer`
+for that, and returned.
+*/
+static struct NODE *expand_node(COUNT index, struct STATEMENT *statement, const struct SOURCE *source, const struct STRUCTURE *structure, C_BUFFER *buffer, C_BUFFER *stack) {
+	const struct NODE *nodes = statement->nodes;
+	assert(index < statement->nodes_count && is_deferred(&nodes[index]));
+	struct NODE *result = push(index * sizeof(struct NODE), alignof(struct NODE), buffer);
+	copy(result, nodes, index * sizeof(struct NODE));
+
+	/* it's parsed as though it weren't deferred, so its own body isn't skipped */
+	struct PARSER parser = create_parser(source, &nodes[index].range, stack);
+	parser.structure = structure;
+	parser.next_structural = find_structural(nodes[index].range.beginning, structure) + 1;
+	SIZE beginning_data_size = buffer->data_size;
+	(VOID)parse_expression(buffer, (PRECEDENCE)-1, &parser);
+	if (parser.token.tag != TOKEN_TAG_terminator)
+		fail(source, &parser.token.range, "unexpected token when parsing expression");
+	COUNT expanded_count = (buffer->data_size - beginning_data_size) / sizeof(struct NODE);
+
+	COUNT rest_count = statement->nodes_count - index - 1;
+	copy(push(rest_count * sizeof(struct NODE), alignof(struct NODE), buffer), nodes + index + 1, rest_count * sizeof(struct NODE));
+	for (COUNT i = 0; i < index; ++i)
+		if (i + result[i].count > index) result[i].count += expanded_count - 1;
+	statement->nodes = result;
+	statement->nodes_count += expanded_count - 1;
+	return result;
+}
+
+/*
+NOTE(Emhyr): a source's fingerprint is a hash of what it parses into: each
+node's tag and how many nodes are under it, and the text of each literal and
+word, but no ranges. so comments and whitespace don't change it, and a build
+can skip whatever depends on a source whose fingerprint hasn't changed. it's
+taken before analysis, which is when literals are evaluated, so a literal is
+hashed by its text.
+*/
+
+static U64 fingerprint_nodes(const struct SOURCE *source, const struct NODE *nodes, COUNT nodes_count) {
+	static const BOOLEAN is_fingerprinted_by_text[NODE_TAGS_COUNT] = {
+		[NODE_TAG_natural]   = 1,
+		[NODE_TAG_real]      = 1,
+		[NODE_TAG_string]    = 1,
+		[NODE_TAG_reference] = 1,
+		[NODE_TAG_name]      = 1,
+	};
+	U64 fingerprint = nodes_count;
+	for (COUNT i = 0; i < nodes_count; ++i) {
+		/*
+		a node's hashed with its index rather than with the node before it, so
+		they're hashed independently. a text of up to 8 bytes is its first and
+		last 4, which is hashed without branching on the tag, since a source
+		can be read a word past its end.
+		*/
+		const struct RANGE *range = &nodes[i].range;
+		COUNT size = range->ending - range->beginning;
+		UTF32 first, last;
+		copy(&first, source->data + range->beginning, sizeof(first));
+		copy(&last, source->data + range->beginning + (size > sizeof(last) ? size - sizeof(last) : 0), sizeof(last));
+		U64 text = ((U64)last << 32 | first) & (U64)-(S64)is_fingerprinted_by_text[nodes[i].tag];
+		text &= size < sizeof(first) ? (1ull << size * 8) - 1 : (U64)-1;
+		U64 node_fingerprint = nodes[i].tag | (U64)nodes[i].count << 32;
+		if (size > sizeof(text) && is_fingerprinted_by_text[nodes[i].tag])
+			node_fingerprint ^= hash_bytes(source->data + range->beginning, size);
+		fingerprint += mix_hash(i * 0x9e3779b97f4a7c15 ^ text, node_fingerprint);
+	}
+	return fingerprint;
+}
+
+static U64 fingerprint_statements(U64 fingerprint, const struct SOURCE *source, const struct STATEMENT *statements, COUNT statements_count) {
+	for (COUNT i = 0; i < statements_count; ++i)
+		fingerprint = mix_hash(fingerprint, fingerprint_nodes(source, statements[i].nodes, statements[i].nodes_count));
+	return fingerprint;
+}
+
+struct WORKER {
+	HANDLE thread;
+	struct BUFFER buffer;
+	const struct SOURCE *source;
+	struct STATEMENT *statements;
+	COUNT statements_count;
+	COUNT *next_statement;
+	const struct STRUCTURE *structure; /* if bodies are deferred */
+	BOOLEAN is_validating; /* if no nodes are built */
+	SIZE stack_peak_size; /* of the parser's stack, which is released once the statements are parsed */
+};
+
+static WORD parse_statements(VOID *parameter) {
+	struct WORKER *worker = parameter;
+	struct BUFFER stack = DEFAULT_BUFFER;
+	for (;;) {
+		COUNT i = __atomic_fetch_add(worker->next_statement, 1, __ATOMIC_RELAXED);
+		if (i >= worker->statements_count) break;
+		struct STATEMENT *statement = &worker->statements[i];
+		struct PARSER parser = create_parser(worker->source, &statement->range, &stack);
+		if (worker->structure) {
+			parser.structure = worker->structure;
+			parser.next_structural = find_structural(statement->range.beginning, worker->structure);
+		}
+		SIZE beginning_data_size = worker->buffer.data_size;
+		if (worker->is_validating) validate_expression(0, &parser);
+		else (VOID)parse_expression(&worker->buffer, 0, &parser);
+		if (parser.token.tag != TOKEN_TAG_semicolon && parser.token.tag != TOKEN_TAG_terminator)
+			fail(worker->source, &parser.token.range, "unexpected token when parsing statement");
+		if (worker->is_validating) continue;
+		statement->nodes = (struct NODE *)((BYTE *)worker->buffer.data + beginning_data_size);
+		statement->nodes_count = (worker->buffer.data_size - beginning_data_size) / sizeof(struct NODE);
+	}
+	if (stack.peak_size > worker->stack_peak_size) worker->stack_peak_size = stack.peak_size;
+	if (stack.data) release_virtual_memory(stack.data, stack.reservation_size);
+	return 0;
+}
+
+/* the statements' nodes live in the workers' buffers, which are left for the caller to use */
+static struct WORKER *parse_source(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count, COUNT workers_count, BOOLEAN is_validating, C_BUFFER *buffer) {
+	if (workers_count > statements_count) workers_count = statements_count;
+	if (!workers_count) workers_count = 1;
+
+	COUNT next_statement = 0;
+	struct WORKER *workers = push(workers_count * sizeof(struct WORKER), alignof(struct WORKER), buffer);
+	for (COUNT i = 0; i < workers_count; ++i) {
+		workers[i] = (struct WORKER){
+			.buffer           = DEFAULT_BUFFER,
+			.source           = source,
+			.statements       = statements,
+			.statements_count = statements_count,
+			.next_statement   = &next_statement,
+			.is_validating    = is_validating,
+		};
+	}
+	for (COUNT i = 1; i < workers_count; ++i)
+		workers[i].thread = create_thread(parse_statements, &workers[i]);
+	(VOID)parse_statements(&workers[0]);
+	for (COUNT i = 1; i < workers_count; ++i)
+		join_thread(workers[i].thread);
+	return workers;
+}
+
+/*
+NOTE(Emhyr): a stream can't be sized or sought, so it's read into a reservation
+that's as big as a source can be, and the window that's committed slides along
+it: pages are committed as they're read into, and decommitted once every
+statement in them is done with. so offsets are still offsets into the stream,
+and ranges are what they'd be for a file, but only a window is ever committed.
+a statement can't be longer than the window. the reservation is kept between
+streams, with nothing committed.
+*/
+
+#define STREAM_RESERVATION_SIZE ((SIZE)(COUNT)-1 + 1)
+#define STREAM_WINDOW_SIZE      MEBIBYTES(4)
+#define STREAM_READ_SIZE        KIBIBYTES(64)
+
+struct STREAM {
+	struct SOURCE source; /* its data is the reservation's, and its size is what's read */
+	struct BUFFER reservation; /* what's committed is before `commission_size`, and after `commission_beginning` */
+	HANDLE file;
+	struct SCANNER scanner;
+	SIZE commission_beginning;
+};
+
+/* a path of `-` is the standard input */
+static VOID begin_stream(const CHAR *path, struct STREAM *stream) {
+	struct BUFFER reservation = stream->reservation;
+	if (!reservation.data) reservation = (struct BUFFER){
+		.reservation_size = STREAM_RESERVATION_SIZE,
+		.commission_rate  = query_system_page_size(),
+		.data             = reserve_virtual_memory(STREAM_RESERVATION_SIZE),
+	};
+	*stream = (struct STREAM){ .reservation = reservation, .scanner = DEFAULT_SCANNER };
+	stream->file = compare_strings(path, "-") ? open_file(path) : get_standard_input();
+	if (stream->file == -1) fail(0, 0, "can't open %s", path);
+	copy(stream->source.path, path, get_size_of_string(path));
+	stream->source.data = reservation.data;
+}
+
+/* returns 0 once the stream's ended */
+static BOOLEAN read_stream(struct STREAM *stream) {
+	SIZE size = stream->source.size;
+	if (size + STREAM_READ_SIZE - stream->scanner.floor > STREAM_WINDOW_SIZE)
+		fail(0, 0, "%s: a statement can't be longer than %u bytes when streamed", stream->source.path, STREAM_WINDOW_SIZE - STREAM_READ_SIZE);
+	if (size + STREAM_READ_SIZE + sizeof(UTF32) > STREAM_RESERVATION_SIZE - 1)
+		fail(0, 0, "%s: the stream is too long", stream->source.path);
+
+	/* the lexer reads a codepoint's worth past a statement */
+	struct BUFFER *reservation = &stream->reservation;
+	SIZE commission_size = align_forwards(size + STREAM_READ_SIZE + sizeof(UTF32), reservation->commission_rate);
+	if (commission_size > reservation->commission_size) {
+		commit_virtual_memory(stream->source.data + reservation->commission_size, commission_size - reservation->commission_size);
+		reservation->commission_size = commission_size;
+	}
+	SIZE read_size = read_from_file(stream->source.data + size, STREAM_READ_SIZE, stream->file);
+	stream->source.size += read_size;
+	reservation->data_size = stream->source.size;
+	if (reservation->commission_size - stream->commission_beginning > reservation->peak_size) reservation->peak_size = reservation->commission_size - stream->commission_beginning;
+	return read_size != 0;
+}
+
+/* decommits what's before the statement that's being scanned */
+static VOID slide_stream(struct STREAM *stream) {
+	raise_floor(stream->scanner.beginning, &stream->scanner, &stream->source);
+	SIZE commission_beginning = stream->scanner.floor & ~(stream->reservation.commission_rate - 1);
+	if (commission_beginning <= stream->commission_beginning) return;
+	decommit_virtual_memory(stream->source.data + stream->commission_beginning, commission_beginning - stream->commission_beginning);
+	stream->commission_beginning = commission_beginning;
+}
+
+/* the window is decommitted, but the reservation is kept for the next stream */
+static VOID end_stream(struct STREAM *stream) {
+	if (compare_strings(stream->source.path, "-")) close_file(stream->file);
+	struct BUFFER reservation = stream->reservation;
+	if (reservation.commission_size > stream->commission_beginning)
+		decommit_virtual_memory((BYTE *)reservation.data + stream->commission_beginning, reservation.commission_size - stream->commission_beginning);
+	reservation.data_size = reservation.commission_size = 0;
+	*stream = (struct STREAM){ .reservation = reservation };
+}
+
+/*
+NOTE(Emhyr): editors and diagnostics ask which node covers an offset. nodes
+are laminar intervals (a child lies within its parent), and they're already
+sorted by beginning in prefix order, so the intervals are kept twice:
+
+- as a partition of the source into segments, each mapped to its innermost
+  node. that answers "which node is at this offset" by binary search.
+- as an implicit augmented binary tree over the sorted array, where every
+  interval knows the maximum ending within its subtree. that answers "which
+  nodes overlap this range" in O(log n + k). it's from Heng Li's cgranges.
+*/
+
+#define NO_INTERVAL ((COUNT)-1)
+
+struct INTERVAL {
+	COUNT beginning;
+	COUNT ending;
+	COUNT maximum_ending;
+	struct NODE *node;
+};
+
+struct SEGMENT {
+	COUNT beginning;
+	COUNT interval;
+};
+
+struct RANGE_INDEX {
+	struct INTERVAL *intervals;
+	COUNT intervals_count;
+	COUNT levels_count;
+	struct SEGMENT *segments;
+	COUNT segments_count;
+};
+
+static inline BOOLEAN precedes_interval(const struct INTERVAL *left, const struct INTERVAL *right) {
+	return left->beginning < right->beginning || left->beginning == right->beginning && left->ending > right->ending;
+}
+
+static VOID sift_interval(struct INTERVAL *intervals, COUNT i, COUNT intervals_count) {
+	for (COUNT child; (child = 2 * i + 1) < intervals_count; i = child) {
+		if (child + 1 < intervals_count && precedes_interval(&intervals[child], &intervals[child + 1])) ++child;
+		if (!precedes_interval(&intervals[i], &intervals[child])) break;
+		struct INTERVAL interval = intervals[i];
+		intervals[i] = intervals[child];
+		intervals[child] = interval;
+	}
+}
+
+/* a heapsort, for it needs no memory; the intervals are usually sorted already */
+static VOID sort_intervals(struct INTERVAL *intervals, COUNT intervals_count) {
+	COUNT i = 1;
+	while (i < intervals_count && !precedes_interval(&intervals[i], &intervals[i - 1])) ++i;
+	if (i >= intervals_count) return;
+	for (i = intervals_count / 2; i--;)
+		sift_interval(intervals, i, intervals_count);
+	for (i = intervals_count; i-- > 1;) {
+		struct INTERVAL interval = intervals[0];
+		intervals[0] = intervals[i];
+		intervals[i] = interval;
+		sift_interval(intervals, 0, i);
+	}
+}
+
+static VOID push_segment(COUNT beginning, COUNT interval, struct RANGE_INDEX *index) {
+	struct SEGMENT *last = index->segments_count ? &index->segments[index->segments_count - 1] : 0;
+	if (last && last->beginning == beginning) last->interval = interval;
+	else if (!last || last->interval != interval) index->segments[index->segments_count++] = (struct SEGMENT){ beginning, interval };
+}
+
+static struct RANGE_INDEX create_range_index(struct STATEMENT *statements, COUNT statements_count, C_BUFFER *buffer) {
+	struct RANGE_INDEX index = { 0 };
+
+	SIZE nodes_count = 0;
+	for (COUNT i = 0; i < statements_count; ++i)
+		nodes_count += statements[i].nodes_count;
+	assert(nodes_count < NO_INTERVAL);
+
+	index.intervals = push(nodes_count * sizeof(struct INTERVAL), alignof(struct INTERVAL), buffer);
+	for (COUNT i = 0; i < statements_count; ++i) {
+		for (COUNT j = 0; j < statements[i].nodes_count; ++j) {
+			struct NODE *node = &statements[i].nodes[j];
+			if (node->range.beginning == node->range.ending) continue;
+			index.intervals[index.intervals_count++] = (struct INTERVAL){
+				.beginning = node->range.beginning,
+				.ending    = node->range.ending,
+				.node      = node,
+			};
+		}
+	}
+	sort_intervals(index.intervals, index.intervals_count);
+
+	/* every interval adds at most two segments: where it begins, and where its parent resumes */
+	index.segments = push((2 * index.intervals_count + 1) * sizeof(struct SEGMENT), alignof(struct SEGMENT), buffer);
+	SIZE stack_data_size = buffer->data_size;
+	COUNT *stack = push(index.intervals_count * sizeof(COUNT), alignof(COUNT), buffer);
+	COUNT stack_size = 0;
+	push_segment(0, NO_INTERVAL, &index);
+	for (COUNT i = 0; i <= index.intervals_count; ++i) {
+		while (stack_size && (i == index.intervals_count || index.intervals[stack[stack_size - 1]].ending <= index.intervals[i].beginning)) {
+			COUNT ending = index.intervals[stack[--stack_size]].ending;
+			push_segment(ending, stack_size ? stack[stack_size - 1] : NO_INTERVAL, &index);
+		}
+		if (i == index.intervals_count) break;
+		push_segment(index.intervals[i].beginning, i, &index);
+		stack[stack_size++] = i;
+	}
+	buffer->data_size = stack_data_size;
+
+	/* the implicit tree: leaves are at even indices, and a node at level `k` has its children `2^(k-1)` away */
+	if (!index.intervals_count) return index;
+	COUNT last_i = 0, last = 0, k;
+	for (COUNT i = 0; i < index.intervals_count; i += 2) {
+		last_i = i;
+		last = index.intervals[i].maximum_ending = index.intervals[i].ending;
+	}
+	for (k = 1; (SIZE)1 << k <= index.intervals_count; ++k) {
+		SIZE x = (SIZE)1 << (k - 1);
+		for (SIZE i = (x << 1) - 1; i < index.intervals_count; i += x << 2) {
+			COUNT left = index.intervals[i - x].maximum_ending;
+			COUNT right = i + x < index.intervals_count ? index.intervals[i + x].maximum_ending : last;
+			COUNT maximum_ending = index.intervals[i].ending;
+			if (maximum_ending < left) maximum_ending = left;
+			if (maximum_ending < right) maximum_ending = right;
+			index.intervals[i].maximum_ending = maximum_ending;
+		}
+		last_i = last_i >> k & 1 ? last_i - x : last_i + x;
+		if (last_i < index.intervals_count && index.intervals[last_i].maximum_ending > last)
+			last = index.intervals[last_i].maximum_ending;
+	}
+	index.levels_count = k;
+	return index;
+}
+
+static struct NODE *find_innermost_node(const struct RANGE_INDEX *index, COUNT offset) {
+	if (!index->segments_count) return 0;
+	COUNT lower = 0, upper = index->segments_count;
+	while (upper - lower > 1) {
+		COUNT middle = lower + (upper - lower) / 2;
+		if (index->segments[middle].beginning <= offset) lower = middle;
+		else upper = middle;
+	}
+	COUNT interval = index->segments[lower].interval;
+	return interval != NO_INTERVAL ? index->intervals[interval].node : 0;
+}
+
+/* pushes the nodes overlapping [`beginning`, `ending`) onto `output`, in order of their beginnings */
+static COUNT find_overlapping_nodes(const struct RANGE_INDEX *index, COUNT beginning, COUNT ending, C_BUFFER *output) {
+	struct FRAME {
+		COUNT level;
+		COUNT i;
+		BOOLEAN is_left_visited;
+	} stack[64];
+	COUNT stack_size = 0, nodes_count = 0;
+	if (!index->intervals_count) return 0;
+	const struct INTERVAL *intervals = index->intervals;
+	SIZE intervals_count = index->intervals_count;
+	COUNT level = index->levels_count - 1;
+	stack[stack_size++] = (struct FRAME){ level, ((SIZE)1 << level) - 1, 0 };
+	while (stack_size) {
+		struct FRAME top = stack[--stack_size];
+		if (top.level <= 3) {
+			/* small subtrees are scanned linearly */
+			SIZE i = (SIZE)top.i >> top.level << top.level;
+			SIZE end = i + ((SIZE)1 << (top.level + 1)) - 1;
+			if (end > intervals_count) end = intervals_count;
+			for (; i < end && intervals[i].beginning < ending; ++i) {
+				if (beginning < intervals[i].ending) {
+					*(struct NODE **)push(sizeof(struct NODE *), alignof(struct NODE *), output) = intervals[i].node;
+					++nodes_count;
+				}
+			}
+		} else if (!top.is_left_visited) {
+			SIZE left = top.i - ((SIZE)1 << (top.level - 1));
+			stack[stack_size++] = (struct FRAME){ top.level, top.i, 1 };
+			if (left >= intervals_count || intervals[left].maximum_ending > beginning)
+				stack[stack_size++] = (struct FRAME){ top.level - 1, left, 0 };
+		} else if (top.i < intervals_count && intervals[top.i].beginning < ending) {
+			if (beginning < intervals[top.i].ending) {
+				*(struct NODE **)push(sizeof(struct NODE *), alignof(struct NODE *), output) = intervals[top.i].node;
+				++nodes_count;
+			}
+			stack[stack_size++] = (struct FRAME){ top.level - 1, top.i + ((SIZE)1 << (top.level - 1)), 0 };
+		}
+	}
+	return nodes_count;
+}
+
+static inline U64 generate_random(U64 *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static inline F64 get_elapsed_seconds(SIZE beginning_counter) {
+	return (F64)(query_performance_counter() - beginning_counter) / query_performance_frequency();
+}
+
+static VOID benchmark_range_index(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	struct BUFFER buffer = DEFAULT_BUFFER, output = DEFAULT_BUFFER;
+	if (!source->size) fail(0, 0, "the source is empty");
+
+	SIZE counter = query_performance_counter();
+	struct RANGE_INDEX index = create_range_index(statements, statements_count, &buffer);
+	F64 seconds = get_elapsed_seconds(counter);
+	report(SEVERITY_comment, 0, 0, "indexed %u intervals into %u segments in %.3f ms", index.intervals_count, index.segments_count, seconds * 1e3);
+
+	enum { QUERIES_COUNT = 1 << 20, WINDOW_SIZE = 64 };
+	U64 random = 0x9e3779b97f4a7c15, checksum = 0;
+	counter = query_performance_counter();
+	for (COUNT i = 0; i < QUERIES_COUNT; ++i)
+		checksum += (ADDRESS)find_innermost_node(&index, generate_random(&random) % source->size);
+	seconds = get_elapsed_seconds(counter);
+	report(SEVERITY_comment, 0, 0, "innermost node: %.0f queries/s", QUERIES_COUNT / seconds);
+
+	/* the tree must agree with a linear scan before it's timed */
+	enum { VERIFICATIONS_COUNT = 1 << 12 };
+	for (COUNT i = 0; i < VERIFICATIONS_COUNT; ++i) {
+		COUNT beginning = generate_random(&random) % source->size;
+		COUNT ending = beginning + 1 + generate_random(&random) % (i & 1 ? WINDOW_SIZE : source->size);
+		output.data_size = 0;
+		COUNT found_count = find_overlapping_nodes(&index, beginning, ending, &output);
+		struct NODE **found = (struct NODE **)output.data;
+		COUNT expected_count = 0;
+		for (COUNT j = 0; j < index.intervals_count; ++j) {
+			const struct INTERVAL *interval = &index.intervals[j];
+			if (interval->beginning >= ending || interval->ending <= beginning) continue;
+			if (expected_count >= found_count || found[expected_count] != interval->node)
+				fail(0, 0, "the overlapping nodes of [%u, %u) differ from a linear scan", beginning, ending);
+			++expected_count;
+		}
+		if (expected_count != found_count)
+			fail(0, 0, "%u nodes overlap [%u, %u), but %u were found", expected_count, beginning, ending, found_count);
+	}
+
+	SIZE nodes_count = 0;
+	counter = query_performance_counter();
+	for (COUNT i = 0; i < QUERIES_COUNT; ++i) {
+		COUNT beginning = generate_random(&random) % source->size;
+		output.data_size = 0;
+		nodes_count += find_overlapping_nodes(&index, beginning, beginning + WINDOW_SIZE, &output);
+	}
+	seconds = get_elapsed_seconds(counter);
+	report(SEVERITY_comment, 0, 0, "overlapping nodes in %u bytes: %.0f queries/s, %.1f nodes per query", WINDOW_SIZE, QUERIES_COUNT / seconds, (F64)nodes_count / QUERIES_COUNT);
+
+	/* for reference, what it costs without the index */
+	COUNT scans_count = 0;
+	counter = query_performance_counter();
+	do {
+		COUNT offset = generate_random(&random) % source->size;
+		const struct INTERVAL *innermost = 0;
+		for (COUNT j = 0; j < index.intervals_count; ++j) {
+			const struct INTERVAL *interval = &index.intervals[j];
+			if (interval->beginning <= offset && offset < interval->ending && (!innermost || interval->beginning >= innermost->beginning)) innermost = interval;
+		}
+		checksum += (ADDRESS)innermost;
+		++scans_count;
+	} while ((seconds = get_elapsed_seconds(counter)) < 0.25);
+	report(SEVERITY_comment, 0, 0, "innermost node by linear scan: %.0f queries/s (checksum %llx)", scans_count / seconds, checksum);
+
+	release_virtual_memory(output.data, output.reservation_size);
+	release_virtual_memory(buffer.data, buffer.reservation_size);
+}
+
+struct INTERNING_THREAD {
+	HANDLE thread;
+	struct INTERNER *interner;
+	const struct SOURCE *source;
+	const struct RANGE *words;
+	COUNT words_count;
+	COUNT first_word;
+	SYMBOL *symbols; /* by word */
+	COUNT *ready_count;
+	BOOLEAN *is_started;
+};
+
+static WORD intern_words(VOID *parameter) {
+	struct INTERNING_THREAD *thread = parameter;
+	(VOID)__atomic_fetch_add(thread->ready_count, 1, __ATOMIC_RELAXED);
+	while (!__atomic_load_n(thread->is_started, __ATOMIC_ACQUIRE)) yield_thread();
+	for (COUNT i = thread->first_word, j = 0; j < thread->words_count; ++j, i = i + 1 < thread->words_count ? i + 1 : 0) {
+		const struct RANGE *word = &thread->words[i];
+		thread->symbols[i] = intern_concurrently(&thread->source->data[word->beginning], word->ending - word->beginning, thread->interner);
+	}
+	return 0;
+}
+
+static VOID release_interner(struct INTERNER *interner) {
+	if (interner->slots) release_virtual_memory(interner->slots, interner->slots_count * sizeof(SYMBOL));
+	if (interner->symbols.data) release_virtual_memory(interner->symbols.data, interner->symbols.reservation_size);
+	if (interner->texts.data) release_virtual_memory(interner->texts.data, interner->texts.reservation_size);
+	*interner = (struct INTERNER){ 0 };
+}
+
+/* every thread interns every word, each starting from its own share of them, so they race for most of the texts */
+static VOID benchmark_interner(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	struct BUFFER words = DEFAULT_BUFFER;
+	SIZE words_size = 0;
+	for (COUNT i = 0; i < statements_count; ++i) {
+		struct LEXER lexer = create_lexer(source, &statements[i].range);
+		for (struct TOKEN token; (token = lex(&lexer)).tag != TOKEN_TAG_terminator;) {
+			if (token.tag != TOKEN_TAG_word) continue;
+			*(struct RANGE *)push(sizeof(struct RANGE), alignof(struct RANGE), &words) = token.range;
+			words_size += token.range.ending - token.range.beginning;
+		}
+	}
+	COUNT words_count = words.data_size / sizeof(struct RANGE);
+	if (!words_count) fail(0, 0, "the source has no words");
+
+	struct INTERNER interner = { 0 };
+	SIZE counter = query_performance_counter();
+	for (COUNT i = 0; i < words_count; ++i) {
+		const struct RANGE *word = (const struct RANGE *)words.data + i;
+		(VOID)intern(&source->data[word->beginning], word->ending - word->beginning, &interner);
+	}
+	F64 seconds = get_elapsed_seconds(counter);
+	COUNT distinct_count = interner.symbols_count;
+	release_interner(&interner);
+	report(SEVERITY_comment, 0, 0, "interned %u words into %u symbols without threads in %.3f ms", words_count, distinct_count, seconds * 1e3);
+
+	enum { RUNS_COUNT = 5, MAXIMUM_THREADS_COUNT = 64 };
+	struct INTERNING_THREAD threads[MAXIMUM_THREADS_COUNT];
+	for (COUNT threads_count = 1; threads_count <= MAXIMUM_THREADS_COUNT; threads_count *= 2) {
+		F64 best_seconds = 1e300;
+		COUNT lost_count = 0;
+		for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+			COUNT ready_count = 0;
+			BOOLEAN is_started = 0;
+			prepare_to_intern(words_count, words_size, threads_count, &interner);
+			for (COUNT i = 0; i < threads_count; ++i) {
+				threads[i] = (struct INTERNING_THREAD){
+					.interner    = &interner,
+					.source      = source,
+					.words       = words.data,
+					.words_count = words_count,
+					.first_word  = (U64)words_count * i / threads_count,
+					.symbols     = allocate_virtual_memory(words_count * sizeof(SYMBOL)),
+					.ready_count = &ready_count,
+					.is_started  = &is_started,
+				};
+			}
+			for (COUNT i = 1; i < threads_count; ++i)
+				threads[i].thread = create_thread(intern_words, &threads[i]);
+			while (__atomic_load_n(&ready_count, __ATOMIC_RELAXED) != threads_count - 1) yield_thread();
+			counter = query_performance_counter();
+			__atomic_store_n(&is_started, 1, __ATOMIC_RELEASE);
+			(VOID)intern_words(&threads[0]);
+			for (COUNT i = 1; i < threads_count; ++i)
+				join_thread(threads[i].thread);
+			seconds = get_elapsed_seconds(counter);
+			if (seconds < best_seconds) best_seconds = seconds;
+
+			/* every thread has to have been given the same symbol for the same word */
+			for (COUNT i = 1; i < threads_count; ++i)
+				for (COUNT j = 0; j < words_count; ++j)
+					if (threads[i].symbols[j] != threads[0].symbols[j]) fail(0, 0, "threads 0 and %u interned word %u differently", i, j);
+			lost_count = interner.symbols_count - distinct_count;
+			for (COUNT i = 0; i < threads_count; ++i)
+				release_virtual_memory(threads[i].symbols, words_count * sizeof(SYMBOL));
+			release_interner(&interner);
+		}
+		report(SEVERITY_comment, 0, 0, "interned %u words with %2u threads in %.3f ms (%.1f million words/s; %u symbols lost to races)",
+			words_count, threads_count, best_seconds * 1e3, (F64)words_count * threads_count / best_seconds / 1e6, lost_count);
+	}
+	release_virtual_memory(words.data, words.reservation_size);
+}
+
+/* parses every statement with and without deferring bodies, and checks that expanding every deferred body gives what's parsed without */
+static VOID benchmark_structure(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	enum { RUNS_COUNT = 5 };
+	struct BUFFER structure_buffer = DEFAULT_BUFFER, statements_buffer = DEFAULT_BUFFER, expansions = DEFAULT_BUFFER, stack = DEFAULT_BUFFER;
+	struct STRUCTURE structure;
+	F64 best_seconds = 1e300;
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		structure_buffer.data_size = 0;
+		SIZE counter = query_performance_counter();
+		structure = index_structure(source, &structure_buffer);
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < best_seconds) best_seconds = seconds;
+	}
+	report(SEVERITY_comment, 0, 0, "indexed %u bodies and strings in %.3f ms (%.2f GB/s)", structure.structurals_count, best_seconds * 1e3, source->size / best_seconds / 1e9);
+
+	struct STATEMENT *copied_statements = push(statements_count * sizeof(struct STATEMENT), alignof(struct STATEMENT), &statements_buffer);
+	F64 eager_seconds = 0;
+	for (COUNT is_lazy = 0; is_lazy < 2; ++is_lazy) {
+		struct WORKER worker = {
+			.buffer           = DEFAULT_BUFFER,
+			.source           = source,
+			.statements       = copied_statements,
+			.statements_count = statements_count,
+			.structure        = is_lazy ? &structure : 0,
+		};
+		best_seconds = 1e300;
+		for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+			COUNT next_statement = 0;
+			copy(copied_statements, statements, statements_count * sizeof(struct STATEMENT));
+			worker.buffer.data_size = 0;
+			worker.next_statement = &next_statement;
+			SIZE counter = query_performance_counter();
+			(VOID)parse_statements(&worker);
+			F64 seconds = get_elapsed_seconds(counter);
+			if (seconds < best_seconds) best_seconds = seconds;
+		}
+		SIZE nodes_count = worker.buffer.data_size / sizeof(struct NODE);
+		if (!is_lazy) {
+			eager_seconds = best_seconds;
+			report(SEVERITY_comment, 0, 0, "parsed %u statements into %llu nodes in %.3f ms", statements_count, nodes_count, best_seconds * 1e3);
+			release_virtual_memory(worker.buffer.data, worker.buffer.reservation_size);
+			continue;
+		}
+		report(SEVERITY_comment, 0, 0, "parsed them into %llu nodes in %.3f ms by deferring bodies (%.2fx)", nodes_count, best_seconds * 1e3, eager_seconds / best_seconds);
+
+		SIZE expansions_count = 0;
+		SIZE counter = query_performance_counter();
+		for (COUNT i = 0; i < statements_count; ++i)
+			for (COUNT j = 0; j < copied_statements[i].nodes_count; ++j)
+				if (is_deferred(&copied_statements[i].nodes[j])) {
+					(VOID)expand_node(j, &copied_statements[i], source, &structure, &expansions, &stack);
+					++expansions_count;
+				}
+		F64 seconds = get_elapsed_seconds(counter);
+		for (COUNT i = 0; i < statements_count; ++i)
+			if (copied_statements[i].nodes_count != statements[i].nodes_count || __builtin_memcmp(copied_statements[i].nodes, statements[i].nodes, statements[i].nodes_count * sizeof(struct NODE)))
+				fail(source, &statements[i].range, "expanding the statement's bodies didn't give what it parses into");
+		report(SEVERITY_comment, 0, 0, "expanded all %llu deferred bodies in %.3f ms, which gave what's parsed without deferring", expansions_count, seconds * 1e3);
+		release_virtual_memory(worker.buffer.data, worker.buffer.reservation_size);
+	}
+
+	if (expansions.data) release_virtual_memory(expansions.data, expansions.reservation_size);
+	if (stack.data) release_virtual_memory(stack.data, stack.reservation_size);
+	release_virtual_memory(statements_buffer.data, statements_buffer.reservation_size);
+	release_virtual_memory(structure_buffer.data, structure_buffer.reservation_size);
+}
+
+static VOID benchmark_syntax(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	enum { RUNS_COUNT = 5 };
+	struct BUFFER statements_buffer = DEFAULT_BUFFER;
+	struct STATEMENT *copied_statements = push(statements_count * sizeof(struct STATEMENT), alignof(struct STATEMENT), &statements_buffer);
+	F64 parsing_seconds = 0;
+	for (COUNT is_validating = 0; is_validating < 2; ++is_validating) {
+		struct WORKER worker = {
+			.buffer           = DEFAULT_BUFFER,
+			.source           = source,
+			.statements       = copied_statements,
+			.statements_count = statements_count,
+			.is_validating    = is_validating,
+		};
+		F64 best_seconds = 1e300;
+		for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+			COUNT next_statement = 0;
+			copy(copied_statements, statements, statements_count * sizeof(struct STATEMENT));
+			worker.buffer.data_size = 0;
+			worker.next_statement = &next_statement;
+			SIZE counter = query_performance_counter();
+			(VOID)parse_statements(&worker);
+			F64 seconds = get_elapsed_seconds(counter);
+			if (seconds < best_seconds) best_seconds = seconds;
+		}
+		if (!is_validating) {
+			parsing_seconds = best_seconds;
+			report(SEVERITY_comment, 0, 0, "parsed %u statements in %.3f ms (%.2f GB/s)", statements_count, best_seconds * 1e3, source->size / best_seconds / 1e9);
+		} else report(SEVERITY_comment, 0, 0, "validated them in %.3f ms (%.2f GB/s, %.2fx)", best_seconds * 1e3, source->size / best_seconds / 1e9, parsing_seconds / best_seconds);
+		if (worker.buffer.data) release_virtual_memory(worker.buffer.data, worker.buffer.reservation_size);
+	}
+	release_virtual_memory(statements_buffer.data, statements_buffer.reservation_size);
+}
+
+static VOID benchmark_tokens(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	enum { RUNS_COUNT = 5, SEEKS_COUNT = 1 << 16 };
+	struct BUFFER materialized = DEFAULT_BUFFER;
+	F64 best_seconds = 1e300;
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		materialized.data_size = 0;
+		SIZE counter = query_performance_counter();
+		for (COUNT i = 0; i < statements_count; ++i) {
+			struct LEXER lexer = create_lexer(source, &statements[i].range);
+			for (struct TOKEN token; (token = lex(&lexer)).tag != TOKEN_TAG_terminator;)
+				*(struct TOKEN *)push(sizeof(struct TOKEN), alignof(struct TOKEN), &materialized) = token;
+		}
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < best_seconds) best_seconds = seconds;
+	}
+	const struct TOKEN *tokens_array = materialized.data;
+	COUNT tokens_count = materialized.data_size / sizeof(struct TOKEN);
+	if (!tokens_count) fail(0, 0, "the source has no tokens");
+	report(SEVERITY_comment, 0, 0, "lexed %u tokens into %llu bytes in %.3f ms", tokens_count, materialized.data_size, best_seconds * 1e3);
+
+	/* the statements are lexed from where they were scanned, by as many workers as there are; one lexer over the whole source must agree */
+	struct LEXER lexer = create_lexer(source, &(struct RANGE){ .ending = source->size, .row = 1, .column = 1 });
+	for (COUNT i = 0; i < tokens_count; ++i) {
+		struct TOKEN token = lex(&lexer);
+		if (token.tag != tokens_array[i].tag || __builtin_memcmp(&token.range, &tokens_array[i].range, sizeof(struct RANGE)))
+			fail(source, &tokens_array[i].range, "the token isn't where lexing the whole source at once puts it");
+	}
+	report(SEVERITY_comment, 0, 0, "lexed the whole source at once into the same tokens at the same positions");
+
+	struct TOKENS tokens = { 0 };
+	best_seconds = 1e300;
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		release_tokens(&tokens);
+		SIZE counter = query_performance_counter();
+		for (COUNT i = 0; i < statements_count; ++i) tokenize(source, &statements[i].range, &tokens);
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < best_seconds) best_seconds = seconds;
+	}
+	SIZE tokens_size = tokens.tags.data_size + tokens.deltas.data_size + tokens.checkpoints.data_size;
+	report(SEVERITY_comment, 0, 0, "lexed them into %llu bytes (%.2f per token, %.2fx smaller) in %.3f ms", tokens_size, (F64)tokens_size / tokens_count, (F64)materialized.data_size / tokens_size, best_seconds * 1e3);
+
+	best_seconds = 1e300;
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		struct TOKEN_CURSOR cursor = seek_token(0, &tokens);
+		SIZE counter = query_performance_counter();
+		for (COUNT i = 0; i < tokens_count; ++i) {
+			struct TOKEN token = decode_token(&tokens, &cursor);
+			if (token.tag != tokens_array[i].tag || __builtin_memcmp(&token.range, &tokens_array[i].range, sizeof(struct RANGE)))
+				fail(source, &tokens_array[i].range, "the token didn't decode into what it was lexed into");
+		}
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < best_seconds) best_seconds = seconds;
+		if (decode_token(&tokens, &cursor).tag != TOKEN_TAG_terminator) fail(0, 0, "the tokens didn't end where they should've");
+	}
+	report(SEVERITY_comment, 0, 0, "decoded and compared them in order in %.3f ms (%.2f ns per token)", best_seconds * 1e3, best_seconds * 1e9 / tokens_count);
+
+	U64 state = 0x9e3779b97f4a7c15;
+	SIZE counter = query_performance_counter();
+	for (COUNT i = 0; i < SEEKS_COUNT; ++i) {
+		state = state * 6364136223846793005 + 1442695040888963407;
+		COUNT index = (state >> 32) % tokens_count;
+		struct TOKEN_CURSOR cursor = seek_token(index, &tokens);
+		struct TOKEN token = decode_token(&tokens, &cursor);
+		if (token.tag != tokens_array[index].tag || __builtin_memcmp(&token.range, &tokens_array[index].range, sizeof(struct RANGE)))
+			fail(source, &tokens_array[index].range, "the token didn't decode into what it was lexed into after seeking it");
+	}
+	F64 seconds = get_elapsed_seconds(counter);
+	report(SEVERITY_comment, 0, 0, "sought %u tokens at random in %.3f ms (%.2f ns per seek)", SEEKS_COUNT, seconds * 1e3, seconds * 1e9 / SEEKS_COUNT);
+
+	release_tokens(&tokens);
+	release_virtual_memory(materialized.data, materialized.reservation_size);
+}
+
+/*
+NOTE(Emhyr): the formatter writes a source back from its tokens, a statement to
+a row, in one pass into one buffer. it doesn't build nodes: an operator that
+follows an operand is binary, and otherwise it's a prefix, which is how the
+parser tells them apart too. so it formats about as fast as it lexes, and what
+doesn't parse is still formatted, token by token.
+
+each token's written as it's spelled in the source, since the lexer already
+decided what it is. binary operators are spaced, prefixes and resolutions
+aren't, brackets hug what's in them, and a comma's followed by a space. blank
+rows between statements are kept as one.
+*/
+
+enum SPACING {
+	SPACING_operator,
+	SPACING_operand,
+	SPACING_opening,
+	SPACING_closing,
+	SPACING_comma,
+	SPACING_semicolon,
+	SPACING_resolution,
+};
+
+static const BYTE spacing_from_token_tag[TOKEN_TAGS_COUNT] = {
+	[0 ...TOKEN_TAGS_COUNT - 1     ] = SPACING_operator,
+	[TOKEN_TAG_undefined           ] = SPACING_operand,
+	[TOKEN_TAG_word                ] = SPACING_operand,
+	[TOKEN_TAG_binary              ] = SPACING_operand,
+	[TOKEN_TAG_octal               ] = SPACING_operand,
+	[TOKEN_TAG_digital             ] = SPACING_operand,
+	[TOKEN_TAG_hexadecimal         ] = SPACING_operand,
+	[TOKEN_TAG_decimal             ] = SPACING_operand,
+	[TOKEN_TAG_text                ] = SPACING_operand,
+	[TOKEN_TAG_left_curly_bracket  ] = SPACING_opening,
+	[TOKEN_TAG_left_parenthesis    ] = SPACING_opening,
+	[TOKEN_TAG_left_square_bracket ] = SPACING_opening,
+	[TOKEN_TAG_right_curly_bracket ] = SPACING_closing,
+	[TOKEN_TAG_right_parenthesis   ] = SPACING_closing,
+	[TOKEN_TAG_right_square_bracket] = SPACING_closing,
+	[TOKEN_TAG_comma               ] = SPACING_comma,
+	[TOKEN_TAG_semicolon           ] = SPACING_semicolon,
+	[TOKEN_TAG_full_stop           ] = SPACING_resolution,
+};
+
+/* appends the formatted source to `text` */
+static VOID format_source(const struct SOURCE *source, const struct STATEMENT *statements, COUNT statements_count, struct BUFFER *text) {
+	/* a token gets a space at most, and a statement two newlines at most */
+	SIZE maximum_size = 2 * (SIZE)source->size + 2 * (SIZE)statements_count;
+	if (!text->data && text->reservation_size < maximum_size) text->reservation_size = align_forwards(maximum_size, GIBIBYTES(1));
+	commit_buffer(maximum_size, text);
+	CHAR *output = (CHAR *)text->data + text->data_size;
+
+	COUNT row = 0; /* where the statement before ended */
+	for (COUNT i = 0; i < statements_count; ++i) {
+		struct LEXER lexer = create_lexer(source, &statements[i].range);
+		struct TOKEN token = lex(&lexer);
+		if (token.tag == TOKEN_TAG_terminator) continue;
+		if (row && token.range.row > row + 1) *output++ = '\n';
+
+		enum SPACING previous_spacing = SPACING_semicolon;
+		enum TOKEN_TAG previous_tag = TOKEN_TAG_undefined;
+		BOOLEAN is_binary = 0; /* if the operator before is */
+		for (; token.tag != TOKEN_TAG_terminator; token = lex(&lexer)) {
+			enum SPACING spacing = spacing_from_token_tag[token.tag];
+			BOOLEAN is_after_operand = previous_spacing == SPACING_operand || previous_spacing == SPACING_closing;
+			BOOLEAN is_spaced = 0;
+			switch (spacing) {
+			case SPACING_operator:
+			case SPACING_operand:
+			case SPACING_opening:
+				is_spaced = is_after_operand || previous_spacing == SPACING_comma || (previous_spacing == SPACING_operator && is_binary);
+				if (spacing == SPACING_operator) is_binary = is_after_operand;
+				break;
+			case SPACING_resolution:
+				/* a natural and a full stop would be lexed as a real */
+				is_spaced = previous_tag >= TOKEN_TAG_binary && previous_tag <= TOKEN_TAG_decimal;
+				break;
+			default:
+				break;
+			}
+			*output = ' ';
+			output += is_spaced;
+			SIZE size = token.range.ending - token.range.beginning;
+			copy(output, source->data + token.range.beginning, size);
+			output += size;
+
+			row = token.range.row;
+			if (token.tag == TOKEN_TAG_text)
+				for (COUNT j = token.range.beginning; j < token.range.ending; ++j) row += source->data[j] == '\n';
+			previous_spacing = spacing;
+			previous_tag = token.tag;
+		}
+		*output++ = '\n';
+	}
+	text->data_size = output - (CHAR *)text->data;
+}
+
+/* checks that formatting keeps the tokens, and that formatting again changes nothing */
+static VOID benchmark_formatter(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	enum { RUNS_COUNT = 5 };
+	F64 lexing_seconds = 1e300, formatting_seconds = 1e300;
+	COUNT tokens_count = 0;
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		tokens_count = 0;
+		SIZE counter = query_performance_counter();
+		for (COUNT i = 0; i < statements_count; ++i) {
+			struct LEXER lexer = create_lexer(source, &statements[i].range);
+			while (lex(&lexer).tag != TOKEN_TAG_terminator) ++tokens_count;
+		}
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < lexing_seconds) lexing_seconds = seconds;
+	}
+	struct BUFFER texts[2] = { DEFAULT_BUFFER, DEFAULT_BUFFER };
+	for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+		texts[0].data_size = 0;
+		SIZE counter = query_performance_counter();
+		format_source(source, statements, statements_count, &texts[0]);
+		F64 seconds = get_elapsed_seconds(counter);
+		if (seconds < formatting_seconds) formatting_seconds = seconds;
+	}
+	report(SEVERITY_comment, 0, 0, "lexed %u tokens in %.3f ms, and formatted them into %llu bytes in %.3f ms (%.2fx)", tokens_count, lexing_seconds * 1e3, texts[0].data_size, formatting_seconds * 1e3, formatting_seconds / lexing_seconds);
+
+	struct SOURCE formatted = *source;
+	formatted.data = texts[0].data;
+	formatted.size = texts[0].data_size;
+	(VOID)push(sizeof(UTF32), 1, &texts[0]);
+	struct BUFFER formatted_statements = DEFAULT_BUFFER;
+	COUNT formatted_statements_count = scan_statements(&formatted, &formatted_statements);
+	format_source(&formatted, formatted_statements.data, formatted_statements_count, &texts[1]);
+	if (texts[1].data_size != formatted.size || __builtin_memcmp(texts[1].data, formatted.data, formatted.size)) fail(source, 0, "formatting the source again changed it");
+
+	struct LEXER lexer = create_lexer(source, &(struct RANGE){ .ending = source->size, .row = 1, .column = 1 });
+	struct LEXER formatted_lexer = create_lexer(&formatted, &(struct RANGE){ .ending = formatted.size, .row = 1, .column = 1 });
+	for (;;) {
+		struct TOKEN token = lex(&lexer), formatted_token = lex(&formatted_lexer);
+		SIZE size = token.range.ending - token.range.beginning;
+		if (token.tag != formatted_token.tag || size != formatted_token.range.ending - formatted_token.range.beginning || __builtin_memcmp(source->data + token.range.beginning, formatted.data + formatted_token.range.beginning, size))
+			fail(source, &token.range, "the formatted source lexed into another token");
+		if (token.tag == TOKEN_TAG_terminator) break;
+	}
+	report(SEVERITY_comment, 0, 0, "the formatted source has the same tokens, and formatting it again doesn't change it");
+
+	release_virtual_memory(formatted_statements.data, formatted_statements.reservation_size);
+	for (COUNT i = 0; i < 2; ++i) release_virtual_memory(texts[i].data, texts[i].reservation_size);
+}
+
+/*
+NOTE(Emhyr): the parser and the folder keep their own stacks, but the passes
+after them recurse once for each level of a tree. a statement that's still
+deeper than this once it's folded fails, rather than overflowing the stack: a
+thread's stack is a mebibyte on Windows, and the deepest of those frames are a
+couple of hundred bytes without optimizations. a constant's folded into a
+literal, so it's as deep as it likes.
+*/
+
+#define MAXIMUM_TREE_DEPTH 2048
+
+/* returns the first node that's deeper than `MAXIMUM_TREE_DEPTH`, or 0 */
+static const struct NODE *find_too_deep_node(const struct NODE *nodes, COUNT nodes_count) {
+	COUNT endings[MAXIMUM_TREE_DEPTH]; /* of the subtrees that the node being read is in */
+	COUNT depth = 0;
+	for (COUNT i = 0; i < nodes_count; ++i) {
+		while (depth && endings[depth - 1] <= i) --depth;
+		if (depth == MAXIMUM_TREE_DEPTH) return &nodes[i];
+		endings[depth++] = i + nodes[i].count;
+	}
+	return 0;
+}
+
+/* the interner is left to the caller */
+static VOID release_analysis(struct TYPES *types, struct DECLARATIONS *declarations) {
+	struct BUFFER *buffers[] = { &types->types, &types->operands, &types->lengths.nodes, &declarations->declarations, &declarations->scopes, &declarations->scope_from_type };
+	for (COUNT i = 0; i < sizeof(buffers) / sizeof(buffers[0]); ++i)
+		if (buffers[i]->data) release_virtual_memory(buffers[i]->data, buffers[i]->reservation_size);
+	if (types->slots) release_virtual_memory(types->slots, types->slots_count * sizeof(TYPE));
+	if (types->lengths.slots) release_virtual_memory(types->lengths.slots, types->lengths.slots_count * sizeof(COUNT));
+	if (declarations->slots) release_virtual_memory(declarations->slots, declarations->slots_count * sizeof(COUNT));
+}
+
+static VOID analyze_statements(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count, struct TYPES *types, struct DECLARATIONS *declarations) {
+	struct BUFFER stack = DEFAULT_BUFFER; /* of the folder */
+	for (COUNT i = 0; i < statements_count; ++i) {
+		statements[i].nodes_count = fold_constants(source, statements[i].nodes, statements[i].nodes_count, &stack);
+		const struct NODE *too_deep_node = find_too_deep_node(statements[i].nodes, statements[i].nodes_count);
+		if (too_deep_node) fail(source, &too_deep_node->range, "the expression is nested more than %u deep", MAXIMUM_TREE_DEPTH);
+		intern_types(statements[i].nodes, statements[i].nodes_count, source, types);
+		statements[i].declaration = declare_statement(statements[i].nodes, statements[i].nodes_count, source, declarations);
+	}
+	if (stack.data) release_virtual_memory(stack.data, stack.reservation_size);
+	for (COUNT i = 0; i < statements_count; ++i)
+		resolve_references(statements[i].nodes, statements[i].nodes_count, source, declarations);
+}
+
+/*
+NOTE(Emhyr): the checker runs each statement as a task on a pool of workers.
+every worker owns a Chase-Lev deque: it pushes and pops its tasks at the bottom,
+and the others steal from the top once theirs run out.
+
+a statement that references a declaration whose statement isn't checked yet is
+suspended rather than waited on: it's pushed onto the declaration's list of
+waiters, and requeued by whichever worker finishes checking the declaration.
+if every remaining task is suspended, then some of them depend on each other
+circularly. each suspended task awaits one declaration, whose statement is
+suspended too, so following them from any task leads into a cycle. the first
+worker to notice finds the cycles and requeues only the tasks in them; the
+references between statements of the same cycle are then reported rather than
+awaited, and the tasks outside of them stay suspended until they're requeued as
+usual. cycles that are found together or later through the same statements are
+merged, so that every round leaves fewer of them.
+
+literals are untyped, so they agree with any type.
+*/
+
+#define CHECKED ((COUNT)-1)
+#define NO_TASK ((COUNT)-1)
+
+enum CHECK {
+	CHECK_undeclared_reference,
+	CHECK_undefined_field,
+	CHECK_mismatched_operands,
+	CHECK_mismatched_assignment,
+	CHECK_circular_reference,
+};
+
+static const CHAR string_from_check[][48] = {
+	[CHECK_undeclared_reference ] = "undeclared reference",
+	[CHECK_undefined_field      ] = "undefined field",
+	[CHECK_mismatched_operands  ] = "operands have mismatched types",
+	[CHECK_mismatched_assignment] = "assignment has mismatched types",
+	[CHECK_circular_reference   ] = "reference depends on itself circularly",
+};
+
+struct DIAGNOSTIC {
+	enum CHECK check;
+	const struct NODE *node;
+};
+
+struct DEQUE {
+	S64 top;
+	S64 bottom;
+	S64 mask;
+	COUNT *tasks;
+};
+
+struct CHECKER_WORKER;
+
+struct CHECKER {
+	struct STATEMENT *statements;
+	COUNT statements_count;
+	struct DECLARATIONS *declarations;
+	struct CHECKER_WORKER *workers;
+	COUNT workers_count;
+	S64 remaining_count;
+	S64 suspended_count;
+	BOOLEAN is_breaking_cycles;
+	COUNT cycles_count;
+	COUNT *statement_from_declaration; /* plus one; 0 when no statement declares it */
+	COUNT *awaited_from_task;          /* for finding cycles */
+	COUNT *walk_from_task;
+	COUNT *merged_from_cycle;
+};
+
+struct CHECKER_WORKER {
+	HANDLE thread;
+	struct CHECKER *checker;
+	struct DEQUE deque;
+	struct BUFFER buffer; /* of diagnostics */
+	U64 random;
+	COUNT awaited; /* the declaration that suspended the current task */
+	SIZE steals_count;
+	SIZE suspensions_count;
+};
+
+static VOID push_task(COUNT task, struct DEQUE *deque) {
+	S64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+	__atomic_store_n(&deque->tasks[bottom & deque->mask], task, __ATOMIC_RELAXED);
+	__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+static COUNT pop_task(struct DEQUE *deque) {
+	S64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	S64 top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+	if (top > bottom) {
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return NO_TASK;
+	}
+	COUNT task = __atomic_load_n(&deque->tasks[bottom & deque->mask], __ATOMIC_RELAXED);
+	if (top == bottom) {
+		/* the last task; race the thieves for it */
+		if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) task = NO_TASK;
+		__atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+	}
+	return task;
+}
+
+static COUNT steal_task(struct DEQUE *deque) {
+	S64 top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	S64 bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+	if (top >= bottom) return NO_TASK;
+	COUNT task = __atomic_load_n(&deque->tasks[top & deque->mask], __ATOMIC_RELAXED);
+	if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) return NO_TASK;
+	return task;
+}
+
+static inline VOID push_diagnostic(enum CHECK check, const struct NODE *node, struct CHECKER_WORKER *worker) {
+	*(struct DIAGNOSTIC *)push(sizeof(struct DIAGNOSTIC), alignof(struct DIAGNOSTIC), &worker->buffer) = (struct DIAGNOSTIC){ check, node };
+}
+
+/* #recursive */
+static TYPE check_subtree(const struct NODE *node, const struct STATEMENT *statement, struct CHECKER_WORKER *worker) {
+	struct DECLARATIONS *declarations = worker->checker->declarations;
+	const struct NODE *child = get_first_child(node), *other_child;
+	TYPE type = 0, other_type;
+	switch (node->tag) {
+	case NODE_TAG_reference:
+		if (!node->value.declaration) {
+			push_diagnostic(CHECK_undeclared_reference, node, worker);
+			break;
+		}
+		struct DECLARATION *declaration = get_declaration(node->value.declaration, declarations);
+		COUNT declarer = worker->checker->statement_from_declaration[node->value.declaration];
+		if (node->value.declaration == statement->declaration) {
+			/* a cycle of one, which is never waited on; the name that's declared refers to it too, but isn't a dependency */
+			if (node != get_first_child(declaration->node)) push_diagnostic(CHECK_circular_reference, node, worker);
+		} else if (declarer && __atomic_load_n(&declaration->waiters, __ATOMIC_ACQUIRE) != CHECKED) {
+			if (!statement->cycle || worker->checker->statements[declarer - 1].cycle != statement->cycle) {
+				worker->awaited = node->value.declaration;
+				return 0;
+			}
+			push_diagnostic(CHECK_circular_reference, node, worker);
+		}
+		type = declaration->type;
+		break;
+	case NODE_TAG_cast:
+		(VOID)check_subtree(child, statement, worker);
+		type = node->value.type;
+		break;
+	case NODE_TAG_resolution:
+		type = check_subtree(child, statement, worker);
+		if (worker->awaited || !get_record_scope(type, declarations)) return 0;
+		other_child = get_next_sibling(child, node);
+		if (other_child->tag != NODE_TAG_reference || !other_child->value.declaration) {
+			push_diagnostic(CHECK_undefined_field, other_child, worker);
+			return 0;
+		}
+		type = get_declaration(other_child->value.declaration, declarations)->type;
+		break;
+	case NODE_TAG_and ... NODE_TAG_rsh:
+	case NODE_TAG_addition ... NODE_TAG_remainder:
+	case NODE_TAG_conjunction:
+	case NODE_TAG_disjunction:
+	case NODE_TAG_equality ... NODE_TAG_lesser_equality:
+	case NODE_TAG_assignment ... NODE_TAG_rsh_assignment:
+		type = check_subtree(child, statement, worker);
+		if (worker->awaited) return 0;
+		other_type = check_subtree(get_next_sibling(child, node), statement, worker);
+		if (worker->awaited) return 0;
+		if (type && other_type && type != other_type)
+			push_diagnostic(node->tag >= NODE_TAG_assignment ? CHECK_mismatched_assignment : CHECK_mismatched_operands, node, worker);
+		if (!type) type = other_type;
+		if (node->tag >= NODE_TAG_equality && node->tag <= NODE_TAG_lesser_equality) type = 0;
+		break;
+	case NODE_TAG_name:
+	case NODE_TAG_record:
+	case NODE_TAG_pointer:
+	case NODE_TAG_array:
+	case NODE_TAG_lambda:
+	case NODE_TAG_field:
+		break;
+	default:
+		for (; child; child = get_next_sibling(child, node)) {
+			(VOID)check_subtree(child, statement, worker);
+			if (worker->awaited) return 0;
+		}
+		break;
+	}
+	return type;
+}
+
+static VOID requeue_waiters(COUNT waiter, struct CHECKER_WORKER *worker) {
+	struct CHECKER *checker = worker->checker;
+	while (waiter) {
+		/* once it's pushed, it may be stolen and suspended again */
+		COUNT task = waiter - 1;
+		waiter = checker->statements[task].next_waiter;
+		__atomic_fetch_sub(&checker->suspended_count, 1, __ATOMIC_RELAXED);
+		push_task(task, &worker->deque);
+	}
+}
+
+static VOID run_task(COUNT task, struct CHECKER_WORKER *worker) {
+	struct CHECKER *checker = worker->checker;
+	struct STATEMENT *statement = &checker->statements[task];
+	SIZE beginning_data_size = worker->buffer.data_size;
+	for (;;) {
+		worker->awaited = 0;
+		if (statement->nodes_count) (VOID)check_subtree(statement->nodes, statement, worker);
+		if (!worker->awaited) break;
+
+		/* suspend, unless it was checked in the meantime */
+		worker->buffer.data_size = beginning_data_size;
+		COUNT *waiters = &get_declaration(worker->awaited, checker->declarations)->waiters;
+		COUNT waiter = __atomic_load_n(waiters, __ATOMIC_ACQUIRE);
+		do {
+			if (waiter == CHECKED) break;
+			statement->next_waiter = waiter;
+		} while (!__atomic_compare_exchange_n(waiters, &waiter, task + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+		if (waiter != CHECKED) {
+			__atomic_fetch_add(&checker->suspended_count, 1, __ATOMIC_RELAXED);
+			++worker->suspensions_count;
+			return;
+		}
+	}
+	statement->diagnostics = (struct DIAGNOSTIC *)((BYTE *)worker->buffer.data + beginning_data_size);
+	statement->diagnostics_count = (worker->buffer.data_size - beginning_data_size) / sizeof(struct DIAGNOSTIC);
+	if (statement->declaration)
+		requeue_waiters(__atomic_exchange_n(&get_declaration(statement->declaration, checker->declarations)->waiters, CHECKED, __ATOMIC_ACQ_REL), worker);
+	__atomic_fetch_sub(&checker->remaining_count, 1, __ATOMIC_RELEASE);
+}
+
+#define IN_CYCLE ((COUNT)-1)
+
+/* only while every remaining task is suspended, so nothing else touches them */
+static VOID break_cycles(struct CHECKER_WORKER *worker) {
+	struct CHECKER *checker = worker->checker;
+	struct STATEMENT *statements = checker->statements;
+	COUNT declarations_count = checker->declarations->declarations_count;
+	COUNT *awaited_from_task = checker->awaited_from_task, *walk_from_task = checker->walk_from_task, *merged_from_cycle = checker->merged_from_cycle;
+	for (COUNT i = 1; i <= declarations_count; ++i) {
+		COUNT waiter = __atomic_load_n(&get_declaration(i, checker->declarations)->waiters, __ATOMIC_ACQUIRE);
+		if (waiter == CHECKED) continue;
+		for (; waiter; waiter = statements[waiter - 1].next_waiter) {
+			awaited_from_task[waiter - 1] = i;
+			walk_from_task[waiter - 1] = 0;
+		}
+	}
+
+	COUNT walk = 0, first_cycle = checker->cycles_count + 1;
+	for (COUNT i = 1; i <= declarations_count; ++i) {
+		COUNT waiter = __atomic_load_n(&get_declaration(i, checker->declarations)->waiters, __ATOMIC_ACQUIRE);
+		if (waiter == CHECKED) continue;
+		for (; waiter; waiter = statements[waiter - 1].next_waiter) {
+			COUNT task = waiter - 1;
+			if (walk_from_task[task]) continue;
+			for (++walk; !walk_from_task[task]; task = checker->statement_from_declaration[awaited_from_task[task]] - 1)
+				walk_from_task[task] = walk;
+			if (walk_from_task[task] != walk) continue;
+
+			/* the walk ran into itself, so `task` is in a cycle */
+			COUNT cycle = ++checker->cycles_count;
+			do {
+				COUNT merged = statements[task].cycle;
+				if (merged) {
+					while (merged_from_cycle[merged]) merged = merged_from_cycle[merged];
+					if (merged != cycle) merged_from_cycle[merged] = cycle;
+				}
+				statements[task].cycle = cycle;
+				walk_from_task[task] = IN_CYCLE;
+				task = checker->statement_from_declaration[awaited_from_task[task]] - 1;
+			} while (walk_from_task[task] != IN_CYCLE);
+		}
+	}
+	if (first_cycle > checker->cycles_count) return;
+	for (COUNT i = 0; i < checker->statements_count; ++i) {
+		COUNT cycle = statements[i].cycle;
+		if (!cycle) continue;
+		while (merged_from_cycle[cycle]) cycle = merged_from_cycle[cycle];
+		statements[i].cycle = cycle;
+	}
+
+	/* the cycles' tasks are requeued, and the others are kept in order */
+	for (COUNT i = 1; i <= declarations_count; ++i) {
+		COUNT *waiters = &get_declaration(i, checker->declarations)->waiters;
+		COUNT waiter = __atomic_load_n(waiters, __ATOMIC_ACQUIRE), *link = waiters;
+		if (waiter == CHECKED) continue;
+		for (; waiter; waiter = statements[waiter - 1].next_waiter) {
+			if (walk_from_task[waiter - 1] != IN_CYCLE) {
+				__atomic_store_n(link, waiter, __ATOMIC_RELEASE);
+				link = &statements[waiter - 1].next_waiter;
+				continue;
+			}
+			__atomic_fetch_sub(&checker->suspended_count, 1, __ATOMIC_RELAXED);
+			push_task(waiter - 1, &worker->deque);
+		}
+		__atomic_store_n(link, 0, __ATOMIC_RELEASE);
+	}
+}
+
+static WORD check_statements_(VOID *parameter) {
+	struct CHECKER_WORKER *worker = parameter;
+	struct CHECKER *checker = worker->checker;
+	for (;;) {
+		S64 remaining_count = __atomic_load_n(&checker->remaining_count, __ATOMIC_ACQUIRE);
+		if (!remaining_count) break;
+
+		COUNT task = pop_task(&worker->deque);
+		for (COUNT i = 0; task == NO_TASK && i < checker->workers_count; ++i) {
+			struct CHECKER_WORKER *victim = &checker->workers[generate_random(&worker->random) % checker->workers_count];
+			if (victim != worker && (task = steal_task(&victim->deque)) != NO_TASK) ++worker->steals_count;
+		}
+		if (task != NO_TASK) {
+			run_task(task, worker);
+			continue;
+		}
+
+		BOOLEAN is_breaking_cycles = 0;
+		if (remaining_count == __atomic_load_n(&checker->suspended_count, __ATOMIC_ACQUIRE)
+			&& __atomic_compare_exchange_n(&checker->is_breaking_cycles, &is_breaking_cycles, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			/* another worker may have broken them in the meantime */
+			if (__atomic_load_n(&checker->remaining_count, __ATOMIC_ACQUIRE) == __atomic_load_n(&checker->suspended_count, __ATOMIC_ACQUIRE))
+				break_cycles(worker);
+			__atomic_store_n(&checker->is_breaking_cycles, 0, __ATOMIC_RELEASE);
+		} else yield_thread();
+	}
+	return 0;
+}
+
+/*
+the diagnostics live in the workers' buffers. they're `buffers`, which are
+reset and then updated, if they're given; otherwise, they're left for the
+caller to release.
+*/
+static struct CHECKER_WORKER *check_statements(struct STATEMENT *statements, COUNT statements_count, struct DECLARATIONS *declarations, COUNT workers_count, struct BUFFER *buffers, C_BUFFER *buffer) {
+	if (!workers_count) workers_count = 1;
+	for (COUNT i = 0; i < statements_count; ++i) {
+		statements[i].next_waiter = 0;
+		statements[i].cycle = 0;
+		statements[i].diagnostics_count = 0;
+	}
+	for (COUNT i = 1; i <= declarations->declarations_count; ++i) {
+		struct DECLARATION *declaration = get_declaration(i, declarations);
+		declaration->waiters = declaration->scope ? CHECKED : 0;
+	}
+
+	struct CHECKER checker = {
+		.statements       = statements,
+		.statements_count = statements_count,
+		.declarations     = declarations,
+		.workers_count    = workers_count,
+		.remaining_count  = statements_count,
+	};
+	checker.workers = push(workers_count * sizeof(struct CHECKER_WORKER), alignof(struct CHECKER_WORKER), buffer);
+	checker.statement_from_declaration = push((declarations->declarations_count + 1) * sizeof(COUNT), alignof(COUNT), buffer);
+	checker.awaited_from_task = push(statements_count * sizeof(COUNT), alignof(COUNT), buffer);
+	checker.walk_from_task = push(statements_count * sizeof(COUNT), alignof(COUNT), buffer);
+	checker.merged_from_cycle = push((statements_count + 1) * sizeof(COUNT), alignof(COUNT), buffer);
+	fill(checker.statement_from_declaration, 0, (declarations->declarations_count + 1) * sizeof(COUNT));
+	fill(checker.merged_from_cycle, 0, (statements_count + 1) * sizeof(COUNT));
+	for (COUNT i = 0; i < statements_count; ++i)
+		if (statements[i].declaration) checker.statement_from_declaration[statements[i].declaration] = i + 1;
+
+	/* every worker's deque can hold every task, and it starts with a contiguous share of them */
+	S64 capacity = 1;
+	while (capacity <= statements_count) capacity <<= 1;
+	for (COUNT i = 0; i < workers_count; ++i) {
+		struct CHECKER_WORKER *worker = &checker.workers[i];
+		*worker = (struct CHECKER_WORKER){
+			.checker = &checker,
+			.deque   = { .mask = capacity - 1, .tasks = allocate_virtual_memory(capacity * sizeof(COUNT)) },
+			.buffer  = buffers ? buffers[i] : DEFAULT_BUFFER,
+			.random  = 0x9e3779b97f4a7c15 * (i + 1),
+		};
+		worker->buffer.data_size = 0;
+		COUNT beginning = (U64)statements_count * i / workers_count, ending = (U64)statements_count * (i + 1) / workers_count;
+		for (COUNT task = ending; task-- > beginning;)
+			push_task(task, &worker->deque);
+	}
+
+	for (COUNT i = 1; i < workers_count; ++i)
+		checker.workers[i].thread = create_thread(check_statements_, &checker.workers[i]);
+	(VOID)check_statements_(&checker.workers[0]);
+	for (COUNT i = 1; i < workers_count; ++i)
+		join_thread(checker.workers[i].thread);
+
+	for (COUNT i = 0; i < workers_count; ++i) {
+		release_virtual_memory(checker.workers[i].deque.tasks, capacity * sizeof(COUNT));
+		if (buffers) buffers[i] = checker.workers[i].buffer;
+		checker.workers[i].checker = 0;
+		checker.workers[i].deque.tasks = 0;
+	}
+	return checker.workers;
+}
+
+static VOID benchmark_checker(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	struct INTERNER interner = { 0 };
+	struct TYPES types = { .lengths.interner = &interner, .interner = &interner };
+	struct DECLARATIONS declarations = { .interner = &interner };
+	analyze_statements(source, statements, statements_count, &types, &declarations);
+
+	enum { RUNS_COUNT = 5 };
+	COUNT processors_count = query_processor_count();
+	F64 first_seconds = 0;
+	for (COUNT workers_count = 1;; workers_count = workers_count * 2 < processors_count ? workers_count * 2 : processors_count) {
+		F64 best_seconds = 1e300;
+		SIZE steals_count = 0, suspensions_count = 0, diagnostics_count = 0;
+		for (COUNT run = 0; run < RUNS_COUNT; ++run) {
+			struct BUFFER buffer = DEFAULT_BUFFER;
+			SIZE counter = query_performance_counter();
+			struct CHECKER_WORKER *workers = check_statements(statements, statements_count, &declarations, workers_count, 0, &buffer);
+			F64 seconds = get_elapsed_seconds(counter);
+			if (seconds < best_seconds) best_seconds = seconds;
+			steals_count = suspensions_count = diagnostics_count = 0;
+			for (COUNT i = 0; i < workers_count; ++i) {
+				steals_count += workers[i].steals_count;
+				suspensions_count += workers[i].suspensions_count;
+				diagnostics_count += workers[i].buffer.data_size / sizeof(struct DIAGNOSTIC);
+				if (workers[i].buffer.data) release_virtual_memory(workers[i].buffer.data, workers[i].buffer.reservation_size);
+			}
+			release_virtual_memory(buffer.data, buffer.reservation_size);
+		}
+		if (workers_count == 1) first_seconds = best_seconds;
+		report(SEVERITY_comment, 0, 0, "checked %u statements with %2u workers in %.3f ms (%.2fx; %llu steals, %llu suspensions, %llu diagnostics)",
+			statements_count, workers_count, best_seconds * 1e3, first_seconds / best_seconds, steals_count, suspensions_count, diagnostics_count);
+		if (workers_count >= processors_count) break;
+	}
+}
+
+/*
+NOTE(Emhyr): statements are evaluated by compiling them into a register-based
+bytecode. an instruction is a word: the opcode, then registers `a`, `b` and
+`c` in a byte each; loads, globals and jumps are followed by a word or two of
+immediate operand. registers are allocated as a stack by depth, so the result
+of a statement is left in register 0. each declaration is a global, indexed by
+the declaration.
+
+values are naturals or reals, and which is decided when compiling: literals are
+what they are, a declaration is whatever its initializer is, and a natural
+meeting a real is converted to a real. naturals wrap, and dividing by zero
+traps.
+
+the interpreter is direct-threaded: every handler jumps straight to the next
+one through a table of label addresses (GNU's computed goto), rather than
+returning to a `switch`.
+*/
+
+enum KIND {
+	KIND_natural,
+	KIND_real,
+};
+
+enum OPCODE {
+	OPCODE_undefined,
+	OPCODE_return,               /* a */
+	OPCODE_load,                 /* a = immediate */
+	OPCODE_load_global,          /* a = globals[immediate] */
+	OPCODE_store_global,         /* globals[immediate] = a */
+	OPCODE_jump,                 /* ip += immediate */
+	OPCODE_jump_if_zero,         /* if !a: ip += immediate */
+	OPCODE_jump_if_nonzero,      /* if a: ip += immediate */
+	OPCODE_real_from_natural,    /* a = b */
+	OPCODE_natural_from_real,    /* a = b */
+	OPCODE_truth,                /* a = b != 0 */
+	OPCODE_real_truth,           /* a = b != 0 */
+	OPCODE_not,                  /* a = ~b */
+	OPCODE_negative,             /* a = -b */
+	OPCODE_negation,             /* a = !b */
+	OPCODE_and,                  /* a = b & c */
+	OPCODE_or,                   /* a = b | c */
+	OPCODE_xor,                  /* a = b ^ c */
+	OPCODE_lsh,                  /* a = b << c */
+	OPCODE_rsh,                  /* a = b >> c */
+	OPCODE_addition,             /* a = b + c */
+	OPCODE_subtraction,          /* a = b - c */
+	OPCODE_multiplication,       /* a = b * c */
+	OPCODE_division,             /* a = b / c */
+	OPCODE_remainder,            /* a = b % c */
+	OPCODE_equality,             /* a = b == c */
+	OPCODE_inequality,           /* a = b != c */
+	OPCODE_greater,              /* a = b > c */
+	OPCODE_lesser,               /* a = b < c */
+	OPCODE_greater_equality,     /* a = b >= c */
+	OPCODE_lesser_equality,      /* a = b <= c */
+	OPCODE_real_negative,        /* a = -b */
+	OPCODE_real_addition,        /* a = b + c */
+	OPCODE_real_subtraction,     /* a = b - c */
+	OPCODE_real_multiplication,  /* a = b * c */
+	OPCODE_real_division,        /* a = b / c */
+	OPCODE_real_equality,        /* a = b == c */
+	OPCODE_real_inequality,      /* a = b != c */
+	OPCODE_real_greater,         /* a = b > c */
+	OPCODE_real_lesser,          /* a = b < c */
+	OPCODE_real_greater_equality,/* a = b >= c */
+	OPCODE_real_lesser_equality, /* a = b <= c */
+
+	OPCODES_COUNT,
+};
+
+static const enum OPCODE opcode_from_node_tag[NODE_TAGS_COUNT][2] = {
+	[NODE_TAG_not             ] = { OPCODE_not,              OPCODE_undefined             },
+	[NODE_TAG_negative        ] = { OPCODE_negative,         OPCODE_real_negative         },
+	[NODE_TAG_and             ] = { OPCODE_and,              OPCODE_undefined             },
+	[NODE_TAG_or              ] = { OPCODE_or,               OPCODE_undefined             },
+	[NODE_TAG_xor             ] = { OPCODE_xor,              OPCODE_undefined             },
+	[NODE_TAG_lsh             ] = { OPCODE_lsh,              OPCODE_undefined             },
+	[NODE_TAG_rsh             ] = { OPCODE_rsh,              OPCODE_undefined             },
+	[NODE_TAG_addition        ] = { OPCODE_addition,         OPCODE_real_addition         },
+	[NODE_TAG_subtraction     ] = { OPCODE_subtraction,      OPCODE_real_subtraction      },
+	[NODE_TAG_multiplication  ] = { OPCODE_multiplication,   OPCODE_real_multiplication   },
+	[NODE_TAG_division        ] = { OPCODE_division,         OPCODE_real_division         },
+	[NODE_TAG_remainder       ] = { OPCODE_remainder,        OPCODE_undefined             },
+	[NODE_TAG_equality        ] = { OPCODE_equality,         OPCODE_real_equality         },
+	[NODE_TAG_inequality      ] = { OPCODE_inequality,       OPCODE_real_inequality       },
+	[NODE_TAG_greater         ] = { OPCODE_greater,          OPCODE_real_greater          },
+	[NODE_TAG_lesser          ] = { OPCODE_lesser,           OPCODE_real_lesser           },
+	[NODE_TAG_greater_equality] = { OPCODE_greater_equality, OPCODE_real_greater_equality },
+	[NODE_TAG_lesser_equality ] = { OPCODE_lesser_equality,  OPCODE_real_lesser_equality  },
+};
+
+static const enum NODE_TAG operation_from_assignment[NODE_TAGS_COUNT] = {
+	[NODE_TAG_addition_assignment      ] = NODE_TAG_addition,
+	[NODE_TAG_subtraction_assignment   ] = NODE_TAG_subtraction,
+	[NODE_TAG_multiplication_assignment] = NODE_TAG_multiplication,
+	[NODE_TAG_division_assignment      ] = NODE_TAG_division,
+	[NODE_TAG_remainder_assignment     ] = NODE_TAG_remainder,
+	[NODE_TAG_and_assignment           ] = NODE_TAG_and,
+	[NODE_TAG_or_assignment            ] = NODE_TAG_or,
+	[NODE_TAG_xor_assignment           ] = NODE_TAG_xor,
+	[NODE_TAG_lsh_assignment           ] = NODE_TAG_lsh,
+	[NODE_TAG_rsh_assignment           ] = NODE_TAG_rsh,
+};
+
+typedef U32 INSTRUCTION;
+
+#define MAXIMUM_REGISTERS_COUNT 256
+#define NO_CHUNK ((COUNT)-1)
+
+/* one for each statement */
+struct CHUNK {
+	COUNT offset; /* NO_CHUNK when it couldn't be compiled */
+	COUNT registers_count;
+	enum KIND kind;
+	const struct NODE *unsupported;
+};
+
+struct BYTECODE {
+	struct BUFFER instructions;
+	struct CHUNK *chunks;
+	enum KIND *kinds; /* of each declaration */
+	const struct NODE *unsupported;
+	COUNT registers_count;
+	const struct DECLARATIONS *declarations;
+};
+
+static inline COUNT get_instructions_count(const struct BYTECODE *bytecode) {
+	return bytecode->instructions.data_size / sizeof(INSTRUCTION);
+}
+
+static inline VOID emit_word(U32 word, struct BYTECODE *bytecode) {
+	*(INSTRUCTION *)push(sizeof(INSTRUCTION), alignof(INSTRUCTION), &bytecode->instructions) = word;
+}
+
+static inline VOID emit(enum OPCODE opcode, COUNT a, COUNT b, COUNT c, struct BYTECODE *bytecode) {
+	emit_word(opcode | a << 8 | b << 16 | c << 24, bytecode);
+}
+
+/* returns where the offset is, to be patched once the target is known */
+static inline COUNT emit_jump(enum OPCODE opcode, COUNT a, struct BYTECODE *bytecode) {
+	emit(opcode, a, 0, 0, bytecode);
+	emit_word(0, bytecode);
+	return get_instructions_count(bytecode) - 1;
+}
+
+static inline VOID patch_jump(COUNT jump, struct BYTECODE *bytecode) {
+	((INSTRUCTION *)bytecode->instructions.data)[jump] = get_instructions_count(bytecode) - (jump + 1);
+}
+
+/* truncated, and 0 when it's out of range */
+static inline U64 convert_real_to_natural(F64 real) {
+	return real > -9223372036854775808.0 && real < 9223372036854775808.0 ? (U64)(S64)real : 0;
+}
+
+static inline VOID convert_register(COUNT r, enum KIND from, enum KIND to, struct BYTECODE *bytecode) {
+	if (from != to) emit(to == KIND_real ? OPCODE_real_from_natural : OPCODE_natural_from_real, r, r, 0, bytecode);
+}
+
+/* the declaration assigned to, or 0 when it isn't a global */
+static COUNT get_assigned_declaration(const struct NODE *node, const struct DECLARATIONS *declarations) {
+	const struct NODE *target = get_first_child(node);
+	if (target->tag == NODE_TAG_cast) target = get_first_child(target);
+	if (target->tag != NODE_TAG_reference || !target->value.declaration) return 0;
+	return get_declaration(target->value.declaration, declarations)->scope ? 0 : target->value.declaration;
+}
+
+/* #recursive */
+static enum KIND infer_kind(const struct NODE *node, const struct BYTECODE *bytecode) {
+	const struct NODE *child = get_first_child(node);
+	switch (node->tag) {
+	case NODE_TAG_real:
+		return KIND_real;
+	case NODE_TAG_reference:
+		return node->value.declaration ? bytecode->kinds[node->value.declaration] : KIND_natural;
+	case NODE_TAG_negative:
+	case NODE_TAG_subexpression:
+	case NODE_TAG_cast:
+		return infer_kind(child, bytecode);
+	case NODE_TAG_addition ... NODE_TAG_division:
+		return infer_kind(child, bytecode) | infer_kind(get_next_sibling(child, node), bytecode);
+	case NODE_TAG_implication:
+		child = get_next_sibling(child, node);
+		return infer_kind(child, bytecode) | infer_kind(get_next_sibling(child, node), bytecode);
+	case NODE_TAG_junction:
+		return infer_kind(get_next_sibling(child, node), bytecode);
+	case NODE_TAG_assignment ... NODE_TAG_rsh_assignment: {
+		COUNT declaration = get_assigned_declaration(node, bytecode->declarations);
+		return declaration ? bytecode->kinds[declaration] : KIND_natural;
+	}
+	default:
+		return KIND_natural;
+	}
+}
+
+/* #recursive */
+static enum KIND compile_subtree(const struct NODE *node, COUNT r, struct BYTECODE *bytecode) {
+	if (bytecode->unsupported) return KIND_natural;
+	if (r >= MAXIMUM_REGISTERS_COUNT - 1) goto unsupported;
+	if (r + 2 > bytecode->registers_count) bytecode->registers_count = r + 2;
+
+	const struct NODE *child = get_first_child(node), *other_child;
+	enum KIND kind = KIND_natural, other_kind;
+	enum OPCODE opcode;
+	COUNT declaration, jump, other_jump;
+	switch (node->tag) {
+	case NODE_TAG_natural:
+	case NODE_TAG_real:
+		emit(OPCODE_load, r, 0, 0, bytecode);
+		emit_word(node->value.natural, bytecode);
+		emit_word(node->value.natural >> 32, bytecode);
+		return node->tag == NODE_TAG_real ? KIND_real : KIND_natural;
+	case NODE_TAG_reference:
+		if (!node->value.declaration || get_declaration(node->value.declaration, bytecode->declarations)->scope) goto unsupported;
+		emit(OPCODE_load_global, r, 0, 0, bytecode);
+		emit_word(node->value.declaration, bytecode);
+		return bytecode->kinds[node->value.declaration];
+	case NODE_TAG_subexpression:
+	case NODE_TAG_cast:
+		return compile_subtree(child, r, bytecode);
+	case NODE_TAG_junction:
+		(VOID)compile_subtree(child, r, bytecode);
+		return compile_subtree(get_next_sibling(child, node), r, bytecode);
+	case NODE_TAG_not:
+	case NODE_TAG_negative:
+		kind = compile_subtree(child, r, bytecode);
+		if (!(opcode = opcode_from_node_tag[node->tag][kind])) goto unsupported;
+		emit(opcode, r, r, 0, bytecode);
+		return kind;
+	case NODE_TAG_negation:
+		kind = compile_subtree(child, r, bytecode);
+		emit(kind == KIND_real ? OPCODE_real_truth : OPCODE_truth, r, r, 0, bytecode);
+		emit(OPCODE_negation, r, r, 0, bytecode);
+		return KIND_natural;
+	case NODE_TAG_conjunction:
+	case NODE_TAG_disjunction:
+		kind = compile_subtree(child, r, bytecode);
+		emit(kind == KIND_real ? OPCODE_real_truth : OPCODE_truth, r, r, 0, bytecode);
+		jump = emit_jump(node->tag == NODE_TAG_conjunction ? OPCODE_jump_if_zero : OPCODE_jump_if_nonzero, r, bytecode);
+		kind = compile_subtree(get_next_sibling(child, node), r, bytecode);
+		emit(kind == KIND_real ? OPCODE_real_truth : OPCODE_truth, r, r, 0, bytecode);
+		patch_jump(jump, bytecode);
+		return KIND_natural;
+	case NODE_TAG_implication:
+		kind = compile_subtree(child, r, bytecode);
+		emit(kind == KIND_real ? OPCODE_real_truth : OPCODE_truth, r, r, 0, bytecode);
+		jump = emit_jump(OPCODE_jump_if_zero, r, bytecode);
+		child = get_next_sibling(child, node);
+		other_child = get_next_sibling(child, node);
+		kind = infer_kind(node, bytecode);
+		convert_register(r, compile_subtree(child, r, bytecode), kind, bytecode);
+		other_jump = emit_jump(OPCODE_jump, 0, bytecode);
+		patch_jump(jump, bytecode);
+		convert_register(r, compile_subtree(other_child, r, bytecode), kind, bytecode);
+		patch_jump(other_jump, bytecode);
+		return kind;
+	case NODE_TAG_and ... NODE_TAG_rsh:
+	case NODE_TAG_addition ... NODE_TAG_remainder:
+	case NODE_TAG_equality ... NODE_TAG_lesser_equality:
+		kind = compile_subtree(child, r, bytecode);
+		other_kind = compile_subtree(get_next_sibling(child, node), r + 1, bytecode);
+		convert_register(r, kind, kind | other_kind, bytecode);
+		convert_register(r + 1, other_kind, kind | other_kind, bytecode);
+		kind |= other_kind;
+		if (!(opcode = opcode_from_node_tag[node->tag][kind])) goto unsupported;
+		emit(opcode, r, r, r + 1, bytecode);
+		return node->tag >= NODE_TAG_equality ? KIND_natural : kind;
+	case NODE_TAG_assignment ... NODE_TAG_rsh_assignment:
+		if (!(declaration = get_assigned_declaration(node, bytecode->declarations))) goto unsupported;
+		kind = bytecode->kinds[declaration];
+		if (node->tag == NODE_TAG_assignment)
+			convert_register(r, compile_subtree(get_next_sibling(child, node), r, bytecode), kind, bytecode);
+		else {
+			emit(OPCODE_load_global, r, 0, 0, bytecode);
+			emit_word(declaration, bytecode);
+			convert_register(r + 1, compile_subtree(get_next_sibling(child, node), r + 1, bytecode), kind, bytecode);
+			if (!(opcode = opcode_from_node_tag[operation_from_assignment[node->tag]][kind])) goto unsupported;
+			emit(opcode, r, r, r + 1, bytecode);
+		}
+		emit(OPCODE_store_global, r, 0, 0, bytecode);
+		emit_word(declaration, bytecode);
+		return kind;
+	default:
+		goto unsupported;
+	}
+
+unsupported:
+	if (!bytecode->unsupported) bytecode->unsupported = node;
+	return KIND_natural;
+}
+
+static VOID compile_statements(struct STATEMENT *statements, COUNT statements_count, const struct DECLARATIONS *declarations, struct BYTECODE *bytecode) {
+	bytecode->declarations = declarations;
+	bytecode->chunks = allocate_virtual_memory((statements_count + 1) * sizeof(struct CHUNK));
+	bytecode->kinds = allocate_virtual_memory((declarations->declarations_count + 1) * sizeof(enum KIND));
+	for (COUNT i = 0; i < statements_count; ++i) {
+		struct STATEMENT *statement = &statements[i];
+		struct CHUNK *chunk = &bytecode->chunks[i];
+		COUNT declaration = statement->declaration;
+		if (declaration) {
+			const struct NODE *value = get_declaration(declaration, declarations)->value;
+			bytecode->kinds[declaration] = value ? infer_kind(value, bytecode) : KIND_natural;
+		}
+
+		*chunk = (struct CHUNK){ .offset = get_instructions_count(bytecode) };
+		bytecode->unsupported = 0;
+		bytecode->registers_count = 0;
+		if (statement->nodes_count) chunk->kind = compile_subtree(statement->nodes, 0, bytecode);
+		else bytecode->unsupported = statement->nodes;
+		if (bytecode->unsupported) {
+			bytecode->instructions.data_size = chunk->offset * sizeof(INSTRUCTION);
+			chunk->offset = NO_CHUNK;
+			chunk->unsupported = bytecode->unsupported;
+			continue;
+		}
+		emit(OPCODE_return, 0, 0, 0, bytecode);
+		chunk->registers_count = bytecode->registers_count;
+	}
+}
+
+/* the instructions are left to the caller */
+static VOID release_bytecode(COUNT statements_count, struct BYTECODE *bytecode) {
+	release_virtual_memory(bytecode->chunks, (statements_count + 1) * sizeof(struct CHUNK));
+	release_virtual_memory(bytecode->kinds, (bytecode->declarations->declarations_count + 1) * sizeof(enum KIND));
+}
+
+/* returns 0 when it traps */
+static BOOLEAN interpret(const INSTRUCTION *ip, union VALUE *registers, union VALUE *globals, union VALUE *result, SIZE *instructions_count) {
+	static const VOID *const labels[OPCODES_COUNT] = {
+		[OPCODE_undefined            ] = &&on_undefined,
+		[OPCODE_return               ] = &&on_return,
+		[OPCODE_load                 ] = &&on_load,
+		[OPCODE_load_global          ] = &&on_load_global,
+		[OPCODE_store_global         ] = &&on_store_global,
+		[OPCODE_jump                 ] = &&on_jump,
+		[OPCODE_jump_if_zero         ] = &&on_jump_if_zero,
+		[OPCODE_jump_if_nonzero      ] = &&on_jump_if_nonzero,
+		[OPCODE_real_from_natural    ] = &&on_real_from_natural,
+		[OPCODE_natural_from_real    ] = &&on_natural_from_real,
+		[OPCODE_truth                ] = &&on_truth,
+		[OPCODE_real_truth           ] = &&on_real_truth,
+		[OPCODE_not                  ] = &&on_not,
+		[OPCODE_negative             ] = &&on_negative,
+		[OPCODE_negation             ] = &&on_negation,
+		[OPCODE_and                  ] = &&on_and,
+		[OPCODE_or                   ] = &&on_or,
+		[OPCODE_xor                  ] = &&on_xor,
+		[OPCODE_lsh                  ] = &&on_lsh,
+		[OPCODE_rsh                  ] = &&on_rsh,
+		[OPCODE_addition             ] = &&on_addition,
+		[OPCODE_subtraction          ] = &&on_subtraction,
+		[OPCODE_multiplication       ] = &&on_multiplication,
+		[OPCODE_division             ] = &&on_division,
+		[OPCODE_remainder            ] = &&on_remainder,
+		[OPCODE_equality             ] = &&on_equality,
+		[OPCODE_inequality           ] = &&on_inequality,
+		[OPCODE_greater              ] = &&on_greater,
+		[OPCODE_lesser               ] = &&on_lesser,
+		[OPCODE_greater_equality     ] = &&on_greater_equality,
+		[OPCODE_lesser_equality      ] = &&on_lesser_equality,
+		[OPCODE_real_negative        ] = &&on_real_negative,
+		[OPCODE_real_addition        ] = &&on_real_addition,
+		[OPCODE_real_subtraction     ] = &&on_real_subtraction,
+		[OPCODE_real_multiplication  ] = &&on_real_multiplication,
+		[OPCODE_real_division        ] = &&on_real_division,
+		[OPCODE_real_equality        ] = &&on_real_equality,
+		[OPCODE_real_inequality      ] = &&on_real_inequality,
+		[OPCODE_real_greater         ] = &&on_real_greater,
+		[OPCODE_real_lesser          ] = &&on_real_lesser,
+		[OPCODE_real_greater_equality] = &&on_real_greater_equality,
+		[OPCODE_real_lesser_equality ] = &&on_real_lesser_equality,
+	};
+
+	INSTRUCTION instruction;
+	SIZE count = 0;
+
+#define A (registers[instruction >> 8  & 0xff])
+#define B (registers[instruction >> 16 & 0xff])
+#define C (registers[instruction >> 24       ])
+#define DISPATCH() do { instruction = *ip++; ++count; goto *labels[instruction & 0xff]; } while (0)
+
+	DISPATCH();
+on_undefined:
+	assert(0);
+on_return:
+	*result = A;
+	*instructions_count += count;
+	return 1;
+on_load:
+	A.natural = ip[0] | (U64)ip[1] << 32;
+	ip += 2;
+	DISPATCH();
+on_load_global:
+	A = globals[*ip++];
+	DISPATCH();
+on_store_global:
+	globals[*ip++] = A;
+	DISPATCH();
+on_jump:
+	ip += 1 + *ip;
+	DISPATCH();
+on_jump_if_zero:
+	ip += A.natural ? 1 : 1 + *ip;
+	DISPATCH();
+on_jump_if_nonzero:
+	ip += A.natural ? 1 + *ip : 1;
+	DISPATCH();
+on_real_from_natural:     A.real = (F64)B.natural;                                  DISPATCH();
+on_natural_from_real:     A.natural = convert_real_to_natural(B.real);              DISPATCH();
+on_truth:                 A.natural = B.natural != 0;                               DISPATCH();
+on_real_truth:            A.natural = B.real != 0;                                  DISPATCH();
+on_not:                   A.natural = ~B.natural;                                   DISPATCH();
+on_negative:              A.natural = -B.natural;                                   DISPATCH();
+on_negation:              A.natural = !B.natural;                                   DISPATCH();
+on_and:                   A.natural = B.natural & C.natural;                        DISPATCH();
+on_or:                    A.natural = B.natural | C.natural;                        DISPATCH();
+on_xor:                   A.natural = B.natural ^ C.natural;                        DISPATCH();
+on_lsh:                   A.natural = C.natural < 64 ? B.natural << C.natural : 0;  DISPATCH();
+on_rsh:                   A.natural = C.natural < 64 ? B.natural >> C.natural : 0;  DISPATCH();
+on_addition:              A.natural = B.natural + C.natural;                        DISPATCH();
+on_subtraction:           A.natural = B.natural - C.natural;                        DISPATCH();
+on_multiplication:        A.natural = B.natural * C.natural;                        DISPATCH();
+on_division:
+	if (!C.natural) goto trapped;
+	A.natural = B.natural / C.natural;
+	DISPATCH();
+on_remainder:
+	if (!C.natural) goto trapped;
+	A.natural = B.natural % C.natural;
+	DISPATCH();
+on_equality:              A.natural = B.natural == C.natural;                       DISPATCH();
+on_inequality:            A.natural = B.natural != C.natural;                       DISPATCH();
+on_greater:               A.natural = B.natural >  C.natural;                       DISPATCH();
+on_lesser:                A.natural = B.natural <  C.natural;                       DISPATCH();
+on_greater_equality:      A.natural = B.natural >= C.natural;                       DISPATCH();
+on_lesser_equality:       A.natural = B.natural <= C.natural;                       DISPATCH();
+on_real_negative:         A.real = -B.real;                                         DISPATCH();
+on_real_addition:         A.real = B.real + C.real;                                 DISPATCH();
+on_real_subtraction:      A.real = B.real - C.real;                                 DISPATCH();
+on_real_multiplication:   A.real = B.real * C.real;                                 DISPATCH();
+on_real_division:
+	if (C.real == 0) goto trapped;
+	A.real = B.real / C.real;
+	DISPATCH();
+on_real_equality:         A.natural = B.real == C.real;                             DISPATCH();
+on_real_inequality:       A.natural = B.real != C.real;                             DISPATCH();
+on_real_greater:          A.natural = B.real >  C.real;                             DISPATCH();
+on_real_lesser:           A.natural = B.real <  C.real;                             DISPATCH();
+on_real_greater_equality: A.natural = B.real >= C.real;                             DISPATCH();
+on_real_lesser_equality:  A.natural = B.real <= C.real;                             DISPATCH();
+
+#undef A
+#undef B
+#undef C
+#undef DISPATCH
+
+trapped:
+	*instructions_count += count;
+	return 0;
+}
+
+/*
+NOTE(Emhyr): for reference, the same semantics evaluated naively: by walking
+the nodes, and deciding each operation and conversion as it's visited.
+*/
+
+struct WALKED {
+	enum KIND kind;
+	union VALUE value;
+};
+
+struct WALKER {
+	const struct BYTECODE *bytecode;
+	union VALUE *globals;
+	SIZE nodes_count;
+	BOOLEAN is_trapped;
+};
+
+static inline union VALUE convert_value(struct WALKED walked, enum KIND kind) {
+	if (walked.kind == kind) return walked.value;
+	return kind == KIND_real ? (union VALUE){ .real = (F64)walked.value.natural } : (union VALUE){ .natural = convert_real_to_natural(walked.value.real) };
+}
+
+static inline U64 get_truth(struct WALKED walked) {
+	return walked.kind == KIND_real ? walked.value.real != 0 : walked.value.natural != 0;
+}
+
+static U64 operate_on_naturals(enum NODE_TAG tag, U64 left, U64 right, struct WALKER *walker) {
+	switch (tag) {
+	case NODE_TAG_and:              return left & right;
+	case NODE_TAG_or:               return left | right;
+	case NODE_TAG_xor:              return left ^ right;
+	case NODE_TAG_lsh:              return right < 64 ? left << right : 0;
+	case NODE_TAG_rsh:              return right < 64 ? left >> right : 0;
+	case NODE_TAG_addition:         return left + right;
+	case NODE_TAG_subtraction:      return left - right;
+	case NODE_TAG_multiplication:   return left * right;
+	case NODE_TAG_division:         if (!right) break; return left / right;
+	case NODE_TAG_remainder:        if (!right) break; return left % right;
+	case NODE_TAG_equality:         return left == right;
+	case NODE_TAG_inequality:       return left != right;
+	case NODE_TAG_greater:          return left >  right;
+	case NODE_TAG_lesser:           return left <  right;
+	case NODE_TAG_greater_equality: return left >= right;
+	case NODE_TAG_lesser_equality:  return left <= right;
+	default:                        break;
+	}
+	walker->is_trapped = 1;
+	return 0;
+}
+
+static union VALUE operate_on_reals(enum NODE_TAG tag, F64 left, F64 right, struct WALKER *walker) {
+	switch (tag) {
+	case NODE_TAG_addition:         return (union VALUE){ .real = left + right };
+	case NODE_TAG_subtraction:      return (union VALUE){ .real = left - right };
+	case NODE_TAG_multiplication:   return (union VALUE){ .real = left * right };
+	case NODE_TAG_division:         if (right == 0) break; return (union VALUE){ .real = left / right };
+	case NODE_TAG_equality:         return (union VALUE){ .natural = left == right };
+	case NODE_TAG_inequality:       return (union VALUE){ .natural = left != right };
+	case NODE_TAG_greater:          return (union VALUE){ .natural = left >  right };
+	case NODE_TAG_lesser:           return (union VALUE){ .natural = left <  right };
+	case NODE_TAG_greater_equality: return (union VALUE){ .natural = left >= right };
+	case NODE_TAG_lesser_equality:  return (union VALUE){ .natural = left <= right };
+	default:                        break;
+	}
+	walker->is_trapped = 1;
+	return (union VALUE){ 0 };
+}
+
+/* #recursive */
+static struct WALKED walk_subtree(const struct NODE *node, struct WALKER *walker) {
+	const struct NODE *child = get_first_child(node), *other_child;
+	struct WALKED walked = { KIND_natural }, other_walked;
+	COUNT declaration;
+	++walker->nodes_count;
+	if (walker->is_trapped) return walked;
+	switch (node->tag) {
+	case NODE_TAG_natural:
+	case NODE_TAG_real:
+		walked.kind = node->tag == NODE_TAG_real ? KIND_real : KIND_natural;
+		walked.value = node->value;
+		break;
+	case NODE_TAG_reference:
+		walked.kind = walker->bytecode->kinds[node->value.declaration];
+		walked.value = walker->globals[node->value.declaration];
+		break;
+	case NODE_TAG_subexpression:
+	case NODE_TAG_cast:
+		walked = walk_subtree(child, walker);
+		break;
+	case NODE_TAG_junction:
+		(VOID)walk_subtree(child, walker);
+		walked = walk_subtree(get_next_sibling(child, node), walker);
+		break;
+	case NODE_TAG_not:
+		walked.value.natural = ~walk_subtree(child, walker).value.natural;
+		break;
+	case NODE_TAG_negative:
+		walked = walk_subtree(child, walker);
+		if (walked.kind == KIND_real) walked.value.real = -walked.value.real;
+		else walked.value.natural = -walked.value.natural;
+		break;
+	case NODE_TAG_negation:
+		walked.value.natural = !get_truth(walk_subtree(child, walker));
+		break;
+	case NODE_TAG_conjunction:
+		walked.value.natural = get_truth(walk_subtree(child, walker)) && get_truth(walk_subtree(get_next_sibling(child, node), walker));
+		break;
+	case NODE_TAG_disjunction:
+		walked.value.natural = get_truth(walk_subtree(child, walker)) || get_truth(walk_subtree(get_next_sibling(child, node), walker));
+		break;
+	case NODE_TAG_implication:
+		other_child = get_next_sibling(child, node);
+		if (!get_truth(walk_subtree(child, walker))) other_child = get_next_sibling(other_child, node);
+		walked.kind = infer_kind(node, walker->bytecode);
+		walked.value = convert_value(walk_subtree(other_child, walker), walked.kind);
+		break;
+	case NODE_TAG_and ... NODE_TAG_rsh:
+	case NODE_TAG_addition ... NODE_TAG_remainder:
+	case NODE_TAG_equality ... NODE_TAG_lesser_equality:
+		walked = walk_subtree(child, walker);
+		other_walked = walk_subtree(get_next_sibling(child, node), walker);
+		enum KIND kind = walked.kind | other_walked.kind;
+		if (kind == KIND_real) walked.value = operate_on_reals(node->tag, convert_value(walked, kind).real, convert_value(other_walked, kind).real, walker);
+		else walked.value.natural = operate_on_naturals(node->tag, walked.value.natural, other_walked.value.natural, walker);
+		walked.kind = node->tag >= NODE_TAG_equality ? KIND_natural : kind;
+		break;
+	case NODE_TAG_assignment ... NODE_TAG_rsh_assignment:
+		declaration = get_assigned_declaration(node, walker->bytecode->declarations);
+		walked.kind = walker->bytecode->kinds[declaration];
+		other_walked = walk_subtree(get_next_sibling(child, node), walker);
+		if (node->tag == NODE_TAG_assignment) walked.value = convert_value(other_walked, walked.kind);
+		else if (walked.kind == KIND_real) walked.value = operate_on_reals(operation_from_assignment[node->tag], walker->globals[declaration].real, convert_value(other_walked, KIND_real).real, walker);
+		else walked.value.natural = operate_on_naturals(operation_from_assignment[node->tag], walker->globals[declaration].natural, convert_value(other_walked, KIND_natural).natural, walker);
+		if (!walker->is_trapped) walker->globals[declaration] = walked.value;
+		break;
+	default:
+		assert(0);
+	}
+	return walked;
+}
+
+static VOID benchmark_interpreter(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count) {
+	struct INTERNER interner = { 0 };
+	struct TYPES types = { .lengths.interner = &interner, .interner = &interner };
+	struct DECLARATIONS declarations = { .interner = &interner };
+	struct BYTECODE bytecode = { .instructions = DEFAULT_BUFFER };
+	analyze_statements(source, statements, statements_count, &types, &declarations);
+	compile_statements(statements, statements_count, &declarations, &bytecode);
+
+	COUNT chunks_count = 0;
+	for (COUNT i = 0; i < statements_count; ++i)
+		chunks_count += bytecode.chunks[i].offset != NO_CHUNK;
+	if (!chunks_count) fail(0, 0, "there's nothing to evaluate");
+	report(SEVERITY_comment, 0, 0, "compiled %u of %u statements into %u instructions", chunks_count, statements_count, get_instructions_count(&bytecode));
+
+	SIZE globals_size = (declarations.declarations_count + 1) * sizeof(union VALUE);
+	union VALUE *globals = allocate_virtual_memory(globals_size);
+	union VALUE registers[MAXIMUM_REGISTERS_COUNT];
+	U64 checksum = 0, other_checksum = 0;
+	SIZE instructions_count = 0, runs_count = 0;
+	F64 seconds;
+	SIZE counter = query_performance_counter();
+	do {
+		fill(globals, 0, globals_size);
+		for (COUNT i = 0; i < statements_count; ++i) {
+			const struct CHUNK *chunk = &bytecode.chunks[i];
+			union VALUE result;
+			if (chunk->offset == NO_CHUNK) continue;
+			if (interpret((INSTRUCTION *)bytecode.instructions.data + chunk->offset, registers, globals, &result, &instructions_count) && !runs_count) checksum = mix_hash(checksum, result.natural);
+		}
+		++runs_count;
+	} while ((seconds = get_elapsed_seconds(counter)) < 0.5);
+	report(SEVERITY_comment, 0, 0, "bytecode:     %.0f instructions/s, %.0f statements/s", instructions_count / seconds, (F64)runs_count * chunks_count / seconds);
+
+	struct WALKER walker = { .bytecode = &bytecode, .globals = globals };
+	runs_count = 0;
+	counter = query_performance_counter();
+	do {
+		fill(globals, 0, globals_size);
+		for (COUNT i = 0; i < statements_count; ++i) {
+			if (bytecode.chunks[i].offset == NO_CHUNK) continue;
+			walker.is_trapped = 0;
+			struct WALKED walked = walk_subtree(statements[i].nodes, &walker);
+			if (!walker.is_trapped && !runs_count) other_checksum = mix_hash(other_checksum, walked.value.natural);
+		}
+		++runs_count;
+	} while ((seconds = get_elapsed_seconds(counter)) < 0.5);
+	report(SEVERITY_comment, 0, 0, "tree walking: %.0f nodes/s, %.0f statements/s", walker.nodes_count / seconds, (F64)runs_count * chunks_count / seconds);
+	if (checksum != other_checksum) fail(0, 0, "the bytecode and the tree walker disagree (%llx and %llx)", checksum, other_checksum);
+
+	release_virtual_memory(globals, globals_size);
+}
+
+/*
+NOTE(Emhyr): the IR is in SSA form, built from the nodes of the statements
+that the bytecode could compile. a whole file is one function: each global is
+an SSA variable that starts out as 0, and every statement ends with a `yield`
+of its value. instructions and blocks live in flat arrays and refer to each
+other by 32-bit indices, where 0 is none; a block's instructions are
+contiguous, with its phis first.
+
+a division is guarded by a `check` that branches off to a block that `trap`s
+and skips the rest of the statement, so the division itself is pure. there
+are no loops, so every edge goes forwards in the order the blocks are made,
+and that order is a topological one. that's what keeps this small: the
+definitions of the globals are tracked with a log of changes as the nodes are
+walked (instead of being searched for across blocks), and the dominators
+settle in one pass.
+
+the operations are the bytecode's, with the IR's own numbered after them. an
+instruction that's replaced by a value becomes a `forward` to the value until
+the IR is compacted, which happens after every pass.
+*/
+
+enum IR_OPCODE {
+	IR_OPCODE_constant = OPCODES_COUNT, /* immediate */
+	IR_OPCODE_phi,                      /* one operand for each predecessor */
+	IR_OPCODE_forward,                  /* a */
+	IR_OPCODE_yield,                    /* a, as the value of the statement `immediate` */
+	IR_OPCODE_trap,                     /* the statement `immediate` */
+	IR_OPCODE_jump,                     /* to the first successor */
+	IR_OPCODE_branch,                   /* to the first successor if a, else the second */
+	IR_OPCODE_check,                    /* to the first successor if a, else the second */
+
+	IR_OPCODES_COUNT,
+};
+
+static const CHAR string_from_ir_opcode[IR_OPCODES_COUNT][24] = {
+	[OPCODE_undefined            ] = "undefined",
+	[OPCODE_real_from_natural    ] = "real_from_natural",
+	[OPCODE_natural_from_real    ] = "natural_from_real",
+	[OPCODE_truth                ] = "truth",
+	[OPCODE_real_truth           ] = "real_truth",
+	[OPCODE_not                  ] = "not",
+	[OPCODE_negative             ] = "negative",
+	[OPCODE_negation             ] = "negation",
+	[OPCODE_and                  ] = "and",
+	[OPCODE_or                   ] = "or",
+	[OPCODE_xor                  ] = "xor",
+	[OPCODE_lsh                  ] = "lsh",
+	[OPCODE_rsh                  ] = "rsh",
+	[OPCODE_addition             ] = "addition",
+	[OPCODE_subtraction          ] = "subtraction",
+	[OPCODE_multiplication       ] = "multiplication",
+	[OPCODE_division             ] = "division",
+	[OPCODE_remainder            ] = "remainder",
+	[OPCODE_equality             ] = "equality",
+	[OPCODE_inequality           ] = "inequality",
+	[OPCODE_greater              ] = "greater",
+	[OPCODE_lesser               ] = "lesser",
+	[OPCODE_greater_equality     ] = "greater_equality",
+	[OPCODE_lesser_equality      ] = "lesser_equality",
+	[OPCODE_real_negative        ] = "real_negative",
+	[OPCODE_real_addition        ] = "real_addition",
+	[OPCODE_real_subtraction     ] = "real_subtraction",
+	[OPCODE_real_multiplication  ] = "real_multiplication",
+	[OPCODE_real_division        ] = "real_division",
+	[OPCODE_real_equality        ] = "real_equality",
+	[OPCODE_real_inequality      ] = "real_inequality",
+	[OPCODE_real_greater         ] = "real_greater",
+	[OPCODE_real_lesser          ] = "real_lesser",
+	[OPCODE_real_greater_equality] = "real_greater_equality",
+	[OPCODE_real_lesser_equality ] = "real_lesser_equality",
+	[IR_OPCODE_constant          ] = "constant",
+	[IR_OPCODE_phi               ] = "phi",
+	[IR_OPCODE_forward           ] = "forward",
+	[IR_OPCODE_yield             ] = "yield",
+	[IR_OPCODE_trap              ] = "trap",
+	[IR_OPCODE_jump              ] = "jump",
+	[IR_OPCODE_branch            ] = "branch",
+	[IR_OPCODE_check             ] = "check",
+};
+
+static const BOOLEAN is_commutative[OPCODES_COUNT] = {
+	[OPCODE_and                ] = 1,
+	[OPCODE_or                 ] = 1,
+	[OPCODE_xor                ] = 1,
+	[OPCODE_addition           ] = 1,
+	[OPCODE_multiplication     ] = 1,
+	[OPCODE_equality           ] = 1,
+	[OPCODE_inequality         ] = 1,
+	[OPCODE_real_addition      ] = 1,
+	[OPCODE_real_multiplication] = 1,
+	[OPCODE_real_equality      ] = 1,
+	[OPCODE_real_inequality    ] = 1,
+};
+
+typedef U32 IR_VALUE;
+
+struct IR_INSTRUCTION {
+	U8 opcode; /* an OPCODE or IR_OPCODE */
+	U8 kind;
+	COUNT block;
+	IR_VALUE operands[2]; /* a phi's are where its operands are, and how many */
+	union VALUE immediate;
+};
+
+struct IR_BLOCK {
+	COUNT first;
+	COUNT count;
+	COUNT predecessors; /* where they are */
+	COUNT predecessors_count;
+	COUNT successors[2];
+	COUNT dominator;       /* immediate */
+	COUNT preorder;        /* in the dominator tree */
+	COUNT dominated_count; /* including itself */
+};
+
+/* a change to the definition of a global */
+struct IR_DEFINITION {
+	COUNT declaration;
+	IR_VALUE previous;
+	IR_VALUE value;
+};
+
+/* a block that traps within the statement being built */
+struct IR_TRAP {
+	COUNT block;
+	COUNT position; /* in the log */
+};
+
+struct IR {
+	struct BUFFER instructions;
+	struct BUFFER blocks;
+	struct BUFFER predecessors;
+	struct BUFFER phi_operands;
+	COUNT instructions_count;
+	COUNT blocks_count;
+
+	/* while building */
+	const struct BYTECODE *bytecode;
+	COUNT block;
+	COUNT statement;
+	IR_VALUE *definitions; /* of each global */
+	struct BUFFER log;
+	struct BUFFER traps;
+	COUNT *stamps;
+	COUNT stamp;
+};
+
+static inline struct IR_INSTRUCTION *get_ir_instruction(IR_VALUE value, const struct IR *ir) {
+	return (struct IR_INSTRUCTION *)ir->instructions.data + value;
+}
+
+static inline struct IR_BLOCK *get_ir_block(COUNT block, const struct IR *ir) {
+	return (struct IR_BLOCK *)ir->blocks.data + block;
+}
+
+static inline COUNT *get_predecessors(const struct IR_BLOCK *block, const struct IR *ir) {
+	return (COUNT *)ir->predecessors.data + block->predecessors;
+}
+
+static inline IR_VALUE *get_phi_operands(const struct IR_INSTRUCTION *phi, const struct IR *ir) {
+	return (IR_VALUE *)ir->phi_operands.data + phi->operands[0];
+}
+
+static inline IR_VALUE *get_ir_operands(struct IR_INSTRUCTION *instruction, COUNT *count, const struct IR *ir) {
+	switch (instruction->opcode) {
+	case IR_OPCODE_phi:
+		*count = instruction->operands[1];
+		return get_phi_operands(instruction, ir);
+	case OPCODE_undefined:
+	case IR_OPCODE_constant:
+	case IR_OPCODE_trap:
+	case IR_OPCODE_jump:
+		*count = 0;
+		return instruction->operands;
+	default:
+		*count = !!instruction->operands[0] + !!instruction->operands[1];
+		return instruction->operands;
+	}
+}
+
+static inline BOOLEAN does_dominate(COUNT block, COUNT other_block, const struct IR *ir) {
+	const struct IR_BLOCK *dominator = get_ir_block(block, ir);
+	COUNT preorder = get_ir_block(other_block, ir)->preorder;
+	return preorder >= dominator->preorder && preorder < dominator->preorder + dominator->dominated_count;
+}
+
+static IR_VALUE emit_ir(U8 opcode, enum KIND kind, IR_VALUE a, IR_VALUE b, struct IR *ir) {
+	*(struct IR_INSTRUCTION *)push(sizeof(struct IR_INSTRUCTION), alignof(struct IR_INSTRUCTION), &ir->instructions) = (struct IR_INSTRUCTION){
+		.opcode   = opcode,
+		.kind     = kind,
+		.block    = ir->block,
+		.operands = { a, b },
+	};
+	++get_ir_block(ir->block, ir)->count;
+	return ir->instructions_count++;
+}
+
+static inline IR_VALUE emit_ir_immediate(enum IR_OPCODE opcode, enum KIND kind, IR_VALUE a, union VALUE immediate, struct IR *ir) {
+	IR_VALUE value = emit_ir(opcode, kind, a, 0, ir);
+	get_ir_instruction(value, ir)->immediate = immediate;
+	return value;
+}
+
+static inline IR_VALUE begin_ir_phi(enum KIND kind, struct IR *ir) {
+	return emit_ir(IR_OPCODE_phi, kind, ir->phi_operands.data_size / sizeof(IR_VALUE), 0, ir);
+}
+
+static inline VOID push_phi_operand(IR_VALUE phi, IR_VALUE value, struct IR *ir) {
+	*(IR_VALUE *)push(sizeof(IR_VALUE), alignof(IR_VALUE), &ir->phi_operands) = value;
+	++get_ir_instruction(phi, ir)->operands[1];
+}
+
+static inline IR_VALUE emit_ir_phi(enum KIND kind, IR_VALUE value, IR_VALUE other_value, struct IR *ir) {
+	IR_VALUE phi = begin_ir_phi(kind, ir);
+	push_phi_operand(phi, value, ir);
+	push_phi_operand(phi, other_value, ir);
+	return phi;
+}
+
+static inline VOID push_predecessor(COUNT block, struct IR *ir) {
+	*(COUNT *)push(sizeof(COUNT), alignof(COUNT), &ir->predecessors) = block;
+}
+
+/* the predecessors are the last `predecessors_count` pushed */
+static COUNT begin_ir_block(COUNT predecessors_count, struct IR *ir) {
+	*(struct IR_BLOCK *)push(sizeof(struct IR_BLOCK), alignof(struct IR_BLOCK), &ir->blocks) = (struct IR_BLOCK){
+		.first              = ir->instructions_count,
+		.predecessors       = ir->predecessors.data_size / sizeof(COUNT) - predecessors_count,
+		.predecessors_count = predecessors_count,
+	};
+	return ir->block = ir->blocks_count++;
+}
+
+static inline COUNT get_log_position(const struct IR *ir) {
+	return ir->log.data_size / sizeof(struct IR_DEFINITION);
+}
+
+static inline struct IR_DEFINITION *get_logged_definition(COUNT position, const struct IR *ir) {
+	return (struct IR_DEFINITION *)ir->log.data + position;
+}
+
+static inline VOID write_definition(COUNT declaration, IR_VALUE value, struct IR *ir) {
+	*(struct IR_DEFINITION *)push(sizeof(struct IR_DEFINITION), alignof(struct IR_DEFINITION), &ir->log) = (struct IR_DEFINITION){ declaration, ir->definitions[declaration], value };
+	ir->definitions[declaration] = value;
+}
+
+/* the definition of a global at `position` in the log, given it can only have changed since `mark` */
+static IR_VALUE get_definition_at(COUNT declaration, COUNT mark, COUNT position, const struct IR *ir) {
+	for (COUNT i = position; i-- > mark;)
+		if (get_logged_definition(i, ir)->declaration == declaration) return get_logged_definition(i, ir)->value;
+	for (COUNT i = mark; i < get_log_position(ir); ++i)
+		if (get_logged_definition(i, ir)->declaration == declaration) return get_logged_definition(i, ir)->previous;
+	return ir->definitions[declaration];
+}
+
+/* returns the next global changed since `mark` (and before `end`) that hasn't been seen, or 0 */
+static inline COUNT get_next_changed_declaration(COUNT *position, COUNT end, struct IR *ir) {
+	for (; *position < end; ++*position) {
+		COUNT declaration = get_logged_definition(*position, ir)->declaration;
+		if (ir->stamps[declaration] == ir->stamp) continue;
+		ir->stamps[declaration] = ir->stamp;
+		return declaration;
+	}
+	return 0;
+}
+
+/* undoes the changes since `mark`, for the other arm of a branch */
+static VOID restore_definitions(COUNT mark, struct IR *ir) {
+	COUNT end = get_log_position(ir), declaration;
+	++ir->stamp;
+	for (COUNT position = mark; (declaration = get_next_changed_declaration(&position, end, ir));) {
+		IR_VALUE previous = get_definition_at(declaration, mark, mark, ir);
+		if (previous != ir->definitions[declaration]) write_definition(declaration, previous, ir);
+	}
+}
+
+/* joins the definitions of two arms: the first as they were at `split`, and the second as they are */
+static VOID merge_definitions(COUNT mark, COUNT split, struct IR *ir) {
+	COUNT end = get_log_position(ir), declaration;
+	++ir->stamp;
+	for (COUNT position = mark; (declaration = get_next_changed_declaration(&position, end, ir));) {
+		IR_VALUE value = get_definition_at(declaration, mark, split, ir), other_value = ir->definitions[declaration];
+		if (value != other_value) write_definition(declaration, emit_ir_phi(ir->bytecode->kinds[declaration], value, other_value, ir), ir);
+	}
+}
+
+static inline enum KIND get_ir_kind(IR_VALUE value, const struct IR *ir) {
+	return get_ir_instruction(value, ir)->kind;
+}
+
+static inline IR_VALUE convert_ir_value(IR_VALUE value, enum KIND kind, struct IR *ir) {
+	if (get_ir_kind(value, ir) == kind) return value;
+	return emit_ir(kind == KIND_real ? OPCODE_real_from_natural : OPCODE_natural_from_real, kind, value, 0, ir);
+}
+
+static inline IR_VALUE build_ir_truth(IR_VALUE value, struct IR *ir) {
+	return emit_ir(get_ir_kind(value, ir) == KIND_real ? OPCODE_real_truth : OPCODE_truth, KIND_natural, value, 0, ir);
+}
+
+static IR_VALUE build_ir_operation(enum OPCODE opcode, enum KIND kind, IR_VALUE value, IR_VALUE other_value, struct IR *ir) {
+	if (opcode == OPCODE_division || opcode == OPCODE_remainder || opcode == OPCODE_real_division) {
+		COUNT from = ir->block;
+		emit_ir(IR_OPCODE_check, get_ir_kind(other_value, ir), other_value, 0, ir);
+		push_predecessor(from, ir);
+		COUNT trap = begin_ir_block(1, ir);
+		emit_ir_immediate(IR_OPCODE_trap, KIND_natural, 0, (union VALUE){ .natural = ir->statement }, ir);
+		emit_ir(IR_OPCODE_jump, KIND_natural, 0, 0, ir);
+		*(struct IR_TRAP *)push(sizeof(struct IR_TRAP), alignof(struct IR_TRAP), &ir->traps) = (struct IR_TRAP){ trap, get_log_position(ir) };
+		push_predecessor(from, ir);
+		get_ir_block(from, ir)->successors[0] = begin_ir_block(1, ir);
+		get_ir_block(from, ir)->successors[1] = trap;
+	}
+	return emit_ir(opcode, kind, value, other_value, ir);
+}
+
+/* #recursive */
+static IR_VALUE build_ir_subtree(const struct NODE *node, struct IR *ir) {
+	const struct NODE *child = get_first_child(node), *other_child;
+	enum KIND kind;
+	IR_VALUE value, other_value;
+	COUNT declaration, from, to, other_to, mark, split;
+	switch (node->tag) {
+	case NODE_TAG_natural:
+	case NODE_TAG_real:
+		return emit_ir_immediate(IR_OPCODE_constant, node->tag == NODE_TAG_real ? KIND_real : KIND_natural, 0, node->value, ir);
+	case NODE_TAG_reference:
+		return ir->definitions[node->value.declaration];
+	case NODE_TAG_subexpression:
+	case NODE_TAG_cast:
+		return build_ir_subtree(child, ir);
+	case NODE_TAG_junction:
+		(VOID)build_ir_subtree(child, ir);
+		return build_ir_subtree(get_next_sibling(child, node), ir);
+	case NODE_TAG_not:
+	case NODE_TAG_negative:
+		value = build_ir_subtree(child, ir);
+		return emit_ir(opcode_from_node_tag[node->tag][get_ir_kind(value, ir)], get_ir_kind(value, ir), value, 0, ir);
+	case NODE_TAG_negation:
+		return emit_ir(OPCODE_negation, KIND_natural, build_ir_truth(build_ir_subtree(child, ir), ir), 0, ir);
+	case NODE_TAG_conjunction:
+	case NODE_TAG_disjunction:
+		value = build_ir_truth(build_ir_subtree(child, ir), ir);
+		from = ir->block;
+		emit_ir(IR_OPCODE_branch, KIND_natural, value, 0, ir);
+		mark = get_log_position(ir);
+		push_predecessor(from, ir);
+		get_ir_block(from, ir)->successors[node->tag == NODE_TAG_disjunction] = begin_ir_block(1, ir);
+		other_value = build_ir_truth(build_ir_subtree(get_next_sibling(child, node), ir), ir);
+		to = ir->block;
+		emit_ir(IR_OPCODE_jump, KIND_natural, 0, 0, ir);
+		push_predecessor(from, ir);
+		push_predecessor(to, ir);
+		get_ir_block(from, ir)->successors[node->tag == NODE_TAG_conjunction] = get_ir_block(to, ir)->successors[0] = begin_ir_block(2, ir);
+		merge_definitions(mark, mark, ir);
+		return emit_ir_phi(KIND_natural, value, other_value, ir);
+	case NODE_TAG_implication:
+		value = build_ir_truth(build_ir_subtree(child, ir), ir);
+		from = ir->block;
+		emit_ir(IR_OPCODE_branch, KIND_natural, value, 0, ir);
+		child = get_next_sibling(child, node);
+		other_child = get_next_sibling(child, node);
+		kind = infer_kind(node, ir->bytecode);
+		mark = get_log_position(ir);
+		push_predecessor(from, ir);
+		get_ir_block(from, ir)->successors[0] = begin_ir_block(1, ir);
+		value = convert_ir_value(build_ir_subtree(child, ir), kind, ir);
+		to = ir->block;
+		emit_ir(IR_OPCODE_jump, KIND_natural, 0, 0, ir);
+		split = get_log_position(ir);
+		restore_definitions(mark, ir);
+		push_predecessor(from, ir);
+		get_ir_block(from, ir)->successors[1] = begin_ir_block(1, ir);
+		other_value = convert_ir_value(build_ir_subtree(other_child, ir), kind, ir);
+		other_to = ir->block;
+		emit_ir(IR_OPCODE_jump, KIND_natural, 0, 0, ir);
+		push_predecessor(to, ir);
+		push_predecessor(other_to, ir);
+		get_ir_block(to, ir)->successors[0] = get_ir_block(other_to, ir)->successors[0] = begin_ir_block(2, ir);
+		merge_definitions(mark, split, ir);
+		return emit_ir_phi(kind, value, other_value, ir);
+	case NODE_TAG_and ... NODE_TAG_rsh:
+	case NODE_TAG_addition ... NODE_TAG_remainder:
+	case NODE_TAG_equality ... NODE_TAG_lesser_equality:
+		value = build_ir_subtree(child, ir);
+		other_value = build_ir_subtree(get_next_sibling(child, node), ir);
+		kind = get_ir_kind(value, ir) | get_ir_kind(other_value, ir);
+		value = convert_ir_value(value, kind, ir);
+		other_value = convert_ir_value(other_value, kind, ir);
+		return build_ir_operation(opcode_from_node_tag[node->tag][kind], node->tag >= NODE_TAG_equality ? KIND_natural : kind, value, other_value, ir);
+	case NODE_TAG_assignment ... NODE_TAG_rsh_assignment:
+		declaration = get_assigned_declaration(node, ir->bytecode->declarations);
+		kind = ir->bytecode->kinds[declaration];
+		value = convert_ir_value(build_ir_subtree(get_next_sibling(child, node), ir), kind, ir);
+		if (node->tag != NODE_TAG_assignment) value = build_ir_operation(opcode_from_node_tag[operation_from_assignment[node->tag]][kind], kind, ir->definitions[declaration], value, ir);
+		write_definition(declaration, value, ir);
+		return value;
+	default:
+		assert(0);
+		return 0;
+	}
+}
+
+static VOID build_ir_statement(const struct STATEMENT *statement, COUNT index, struct IR *ir) {
+	ir->statement = index;
+	ir->traps.data_size = 0;
+	COUNT mark = get_log_position(ir);
+	IR_VALUE value = build_ir_subtree(statement->nodes, ir);
+	emit_ir_immediate(IR_OPCODE_yield, ir->bytecode->chunks[index].kind, value, (union VALUE){ .natural = index }, ir);
+
+	/* the traps skip the rest of the statement, so they join the globals as they were when trapping */
+	const struct IR_TRAP *traps = ir->traps.data;
+	COUNT traps_count = ir->traps.data_size / sizeof(struct IR_TRAP), end = get_log_position(ir), declaration;
+	if (!traps_count) return;
+	COUNT from = ir->block;
+	emit_ir(IR_OPCODE_jump, KIND_natural, 0, 0, ir);
+	for (COUNT i = 0; i < traps_count; ++i)
+		push_predecessor(traps[i].block, ir);
+	push_predecessor(from, ir);
+	COUNT join = begin_ir_block(traps_count + 1, ir);
+	for (COUNT i = 0; i < traps_count; ++i)
+		get_ir_block(traps[i].block, ir)->successors[0] = join;
+	get_ir_block(from, ir)->successors[0] = join;
+	++ir->stamp;
+	for (COUNT position = mark; (declaration = get_next_changed_declaration(&position, end, ir));) {
+		IR_VALUE current = ir->definitions[declaration];
+		COUNT i = 0;
+		while (i < traps_count && get_definition_at(declaration, mark, traps[i].position, ir) == current) ++i;
+		if (i == traps_count) continue;
+		IR_VALUE phi = begin_ir_phi(ir->bytecode->kinds[declaration], ir);
+		for (i = 0; i < traps_count; ++i)
+			push_phi_operand(phi, get_definition_at(declaration, mark, traps[i].position, ir), ir);
+		push_phi_operand(phi, current, ir);
+		write_definition(declaration, phi, ir);
+	}
+}
+
+static VOID build_ir(const struct STATEMENT *statements, COUNT statements_count, const struct BYTECODE *bytecode, struct IR *ir) {
+	COUNT declarations_count = bytecode->declarations->declarations_count;
+	SIZE definitions_size = (declarations_count + 1) * sizeof(IR_VALUE), stamps_size = (declarations_count + 1) * sizeof(COUNT);
+	ir->bytecode = bytecode;
+	ir->definitions = allocate_virtual_memory(definitions_size);
+	ir->stamps = allocate_virtual_memory(stamps_size);
+	(VOID)push(sizeof(struct IR_INSTRUCTION), alignof(struct IR_INSTRUCTION), &ir->instructions);
+	(VOID)push(sizeof(struct IR_BLOCK), alignof(struct IR_BLOCK), &ir->blocks);
+	ir->instructions_count = ir->blocks_count = 1;
+	(VOID)begin_ir_block(0, ir);
+
+	IR_VALUE zeros[2] = {
+		[KIND_natural] = emit_ir_immediate(IR_OPCODE_constant, KIND_natural, 0, (union VALUE){ .natural = 0 }, ir),
+		[KIND_real   ] = emit_ir_immediate(IR_OPCODE_constant, KIND_real,    0, (union VALUE){ .real    = 0 }, ir),
+	};
+	for (COUNT i = 1; i <= declarations_count; ++i)
+		ir->definitions[i] = zeros[bytecode->kinds[i]];
+	for (COUNT i = 0; i < statements_count; ++i)
+		if (bytecode->chunks[i].offset != NO_CHUNK) build_ir_statement(&statements[i], i, ir);
+
+	release_virtual_memory(ir->definitions, definitions_size);
+	release_virtual_memory(ir->stamps, stamps_size);
+	if (ir->log.data) release_virtual_memory(ir->log.data, ir->log.reservation_size);
+	if (ir->traps.data) release_virtual_memory(ir->traps.data, ir->traps.reservation_size);
+}
+
+static VOID release_ir(struct IR *ir) {
+	release_virtual_memory(ir->instructions.data, ir->instructions.reservation_size);
+	release_virtual_memory(ir->blocks.data, ir->blocks.reservation_size);
+	if (ir->predecessors.data) release_virtual_memory(ir->predecessors.data, ir->predecessors.reservation_size);
+	if (ir->phi_operands.data) release_virtual_memory(ir->phi_operands.data, ir->phi_operands.reservation_size);
+}
+
+/*
+NOTE(Emhyr): the blocks are in a topological order, so a block's predecessors
+have their immediate dominators before it does, and the intersection walks
+up by index (Cooper, Harvey and Kennedy's, without iterating). the dominator
+tree is then numbered in preorder, so a block dominates another when the
+other's number is within its subtree.
+*/
+
+static VOID compute_dominators(struct IR *ir) {
+	for (COUNT b = 2; b < ir->blocks_count; ++b) {
+		struct IR_BLOCK *block = get_ir_block(b, ir);
+		const COUNT *predecessors = get_predecessors(block, ir);
+		COUNT dominator = predecessors[0];
+		for (COUNT i = 1; i < block->predecessors_count; ++i) {
+			COUNT other = predecessors[i];
+			while (dominator != other) {
+				while (dominator > other) dominator = get_ir_block(dominator, ir)->dominator;
+				while (other > dominator) other = get_ir_block(other, ir)->dominator;
+			}
+		}
+		block->dominator = dominator;
+	}
+
+	get_ir_block(1, ir)->dominator = get_ir_block(1, ir)->preorder = 0;
+	for (COUNT b = 1; b < ir->blocks_count; ++b)
+		get_ir_block(b, ir)->dominated_count = 1;
+	for (COUNT b = ir->blocks_count; --b > 1;)
+		get_ir_block(get_ir_block(b, ir)->dominator, ir)->dominated_count += get_ir_block(b, ir)->dominated_count;
+	SIZE nexts_size = ir->blocks_count * sizeof(COUNT);
+	COUNT *nexts = allocate_virtual_memory(nexts_size); /* the preorder of the next child */
+	nexts[1] = 1;
+	for (COUNT b = 2; b < ir->blocks_count; ++b) {
+		struct IR_BLOCK *block = get_ir_block(b, ir);
+		block->preorder = nexts[block->dominator];
+		nexts[block->dominator] += block->dominated_count;
+		nexts[b] = block->preorder + 1;
+	}
+	release_virtual_memory(nexts, nexts_size);
+}
+
+static inline IR_VALUE resolve_ir_value(IR_VALUE value, const struct IR *ir) {
+	while (get_ir_instruction(value, ir)->opcode == IR_OPCODE_forward) value = get_ir_instruction(value, ir)->operands[0];
+	return value;
+}
+
+static inline VOID forward_ir_value(IR_VALUE value, IR_VALUE to, struct IR *ir) {
+	struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+	instruction->opcode = IR_OPCODE_forward;
+	instruction->operands[0] = to;
+	instruction->operands[1] = 0;
+}
+
+static VOID remove_ir_block(COUNT block, struct IR *ir);
+
+/* along with the operands of the successor's phis */
+static VOID remove_ir_edge(COUNT from, COUNT to, struct IR *ir) {
+	struct IR_BLOCK *block = get_ir_block(to, ir);
+	COUNT *predecessors = get_predecessors(block, ir);
+	COUNT i = 0;
+	while (predecessors[i] != from) ++i;
+	--block->predecessors_count;
+	move(predecessors + i, predecessors + i + 1, (block->predecessors_count - i) * sizeof(COUNT));
+	for (IR_VALUE value = block->first; value < block->first + block->count; ++value) {
+		struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+		if (instruction->opcode != IR_OPCODE_phi) continue;
+		IR_VALUE *operands = get_phi_operands(instruction, ir);
+		--instruction->operands[1];
+		move(operands + i, operands + i + 1, (instruction->operands[1] - i) * sizeof(IR_VALUE));
+	}
+	if (!block->predecessors_count) remove_ir_block(to, ir);
+}
+
+/* #recursive */
+static VOID remove_ir_block(COUNT block, struct IR *ir) {
+	struct IR_BLOCK *removed = get_ir_block(block, ir);
+	for (IR_VALUE value = removed->first; value < removed->first + removed->count; ++value)
+		get_ir_instruction(value, ir)->opcode = OPCODE_undefined;
+	for (COUNT i = 0; i < 2; ++i)
+		if (removed->successors[i]) remove_ir_edge(block, removed->successors[i], ir);
+	removed->successors[0] = removed->successors[1] = 0;
+}
+
+/* makes a branch or check into a jump to one of its successors */
+static VOID fold_ir_branch(COUNT block, IR_VALUE value, COUNT successor, struct IR *ir) {
+	struct IR_BLOCK *folded = get_ir_block(block, ir);
+	struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+	instruction->opcode = IR_OPCODE_jump;
+	instruction->operands[0] = 0;
+	COUNT kept = folded->successors[successor], removed = folded->successors[!successor];
+	folded->successors[0] = kept;
+	folded->successors[1] = 0;
+	remove_ir_edge(block, removed, ir);
+}
+
+/* returns 0 when it would trap */
+static BOOLEAN fold_operation(enum OPCODE opcode, union VALUE b, union VALUE c, union VALUE *a) {
+	switch (opcode) {
+	case OPCODE_real_from_natural:     a->real = (F64)b.natural;                                 break;
+	case OPCODE_natural_from_real:     a->natural = convert_real_to_natural(b.real);             break;
+	case OPCODE_truth:                 a->natural = b.natural != 0;                              break;
+	case OPCODE_real_truth:            a->natural = b.real != 0;                                 break;
+	case OPCODE_not:                   a->natural = ~b.natural;                                  break;
+	case OPCODE_negative:              a->natural = -b.natural;                                  break;
+	case OPCODE_negation:              a->natural = !b.natural;                                  break;
+	case OPCODE_and:                   a->natural = b.natural & c.natural;                       break;
+	case OPCODE_or:                    a->natural = b.natural | c.natural;                       break;
+	case OPCODE_xor:                   a->natural = b.natural ^ c.natural;                       break;
+	case OPCODE_lsh:                   a->natural = c.natural < 64 ? b.natural << c.natural : 0; break;
+	case OPCODE_rsh:                   a->natural = c.natural < 64 ? b.natural >> c.natural : 0; break;
+	case OPCODE_addition:              a->natural = b.natural + c.natural;                       break;
+	case OPCODE_subtraction:           a->natural = b.natural - c.natural;                       break;
+	case OPCODE_multiplication:        a->natural = b.natural * c.natural;                       break;
+	case OPCODE_division:              if (!c.natural) return 0; a->natural = b.natural / c.natural; break;
+	case OPCODE_remainder:             if (!c.natural) return 0; a->natural = b.natural % c.natural; break;
+	case OPCODE_equality:              a->natural = b.natural == c.natural;                      break;
+	case OPCODE_inequality:            a->natural = b.natural != c.natural;                      break;
+	case OPCODE_greater:               a->natural = b.natural >  c.natural;                      break;
+	case OPCODE_lesser:                a->natural = b.natural <  c.natural;                      break;
+	case OPCODE_greater_equality:      a->natural = b.natural >= c.natural;                      break;
+	case OPCODE_lesser_equality:       a->natural = b.natural <= c.natural;                      break;
+	case OPCODE_real_negative:         a->real = -b.real;                                        break;
+	case OPCODE_real_addition:         a->real = b.real + c.real;                                break;
+	case OPCODE_real_subtraction:      a->real = b.real - c.real;                                break;
+	case OPCODE_real_multiplication:   a->real = b.real * c.real;                                break;
+	case OPCODE_real_division:         if (c.real == 0) return 0; a->real = b.real / c.real;     break;
+	case OPCODE_real_equality:         a->natural = b.real == c.real;                            break;
+	case OPCODE_real_inequality:       a->natural = b.real != c.real;                            break;
+	case OPCODE_real_greater:          a->natural = b.real >  c.real;                            break;
+	case OPCODE_real_lesser:           a->natural = b.real <  c.real;                            break;
+	case OPCODE_real_greater_equality: a->natural = b.real >= c.real;                            break;
+	case OPCODE_real_lesser_equality:  a->natural = b.real <= c.real;                            break;
+	default:                           return 0;
+	}
+	return 1;
+}
+
+static inline BOOLEAN is_ir_constant(IR_VALUE value, const struct IR *ir) {
+	return get_ir_instruction(value, ir)->opcode == IR_OPCODE_constant;
+}
+
+/* in the order of the blocks, so every operand is visited before its users */
+static VOID propagate_constants(struct IR *ir) {
+	for (COUNT b = 1; b < ir->blocks_count; ++b) {
+		const struct IR_BLOCK *block = get_ir_block(b, ir);
+		if (b != 1 && !block->predecessors_count) continue;
+		for (IR_VALUE value = block->first; value < block->first + block->count; ++value) {
+			struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+			COUNT operands_count;
+			IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+			BOOLEAN are_constant = 1;
+			for (COUNT i = 0; i < operands_count; ++i) {
+				operands[i] = resolve_ir_value(operands[i], ir);
+				are_constant &= is_ir_constant(operands[i], ir);
+			}
+			switch (instruction->opcode) {
+			case IR_OPCODE_phi: {
+				COUNT i = 1;
+				while (i < operands_count && (operands[i] == operands[0] || (are_constant && get_ir_instruction(operands[i], ir)->immediate.natural == get_ir_instruction(operands[0], ir)->immediate.natural))) ++i;
+				if (i == operands_count) forward_ir_value(value, operands[0], ir);
+				break;
+			}
+			case IR_OPCODE_branch:
+			case IR_OPCODE_check:
+				if (!are_constant) break;
+				union VALUE condition = get_ir_instruction(operands[0], ir)->immediate;
+				fold_ir_branch(b, value, instruction->kind == KIND_real ? condition.real == 0 : condition.natural == 0, ir);
+				break;
+			default:
+				if (instruction->opcode >= OPCODES_COUNT || !are_constant) break;
+				union VALUE result;
+				if (!fold_operation(instruction->opcode, get_ir_instruction(operands[0], ir)->immediate, get_ir_instruction(operands[1], ir)->immediate, &result)) break;
+				instruction->opcode = IR_OPCODE_constant;
+				instruction->operands[0] = instruction->operands[1] = 0;
+				instruction->immediate = result;
+				break;
+			}
+		}
+	}
+}
+
+static inline BOOLEAN are_ir_instructions_equal(const struct IR_INSTRUCTION *instruction, const struct IR_INSTRUCTION *other_instruction) {
+	return instruction->opcode == other_instruction->opcode
+		&& instruction->kind == other_instruction->kind
+		&& instruction->operands[0] == other_instruction->operands[0]
+		&& instruction->operands[1] == other_instruction->operands[1]
+		&& instruction->immediate.natural == other_instruction->immediate.natural;
+}
+
+/*
+NOTE(Emhyr): values are numbered by their operation and operands in one table
+across the function, and an equal instruction is reused when its block
+dominates. a check is redundant when the one before it passed, so it's made a
+jump when the earlier check's first successor dominates it.
+*/
+
+/* returns 0 when there's an equal instruction that dominates it, after putting the instruction in its place */
+static BOOLEAN number_ir_value(IR_VALUE value, IR_VALUE *slots, COUNT slots_count, struct IR *ir) {
+	struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+	U64 hash = mix_hash(mix_hash(mix_hash(instruction->opcode | instruction->kind << 8, instruction->operands[0]), instruction->operands[1]), instruction->immediate.natural);
+	COUNT i = hash & (slots_count - 1);
+	for (; slots[i]; i = (i + 1) & (slots_count - 1)) {
+		const struct IR_INSTRUCTION *other_instruction = get_ir_instruction(slots[i], ir);
+		if (!are_ir_instructions_equal(instruction, other_instruction)) continue;
+		if (instruction->opcode == IR_OPCODE_check) {
+			if (!does_dominate(get_ir_block(other_instruction->block, ir)->successors[0], instruction->block, ir)) break;
+			fold_ir_branch(instruction->block, value, 0, ir);
+			return 0;
+		}
+		if (!does_dominate(other_instruction->block, instruction->block, ir)) break;
+		forward_ir_value(value, slots[i], ir);
+		return 0;
+	}
+	slots[i] = value;
+	return 1;
+}
+
+static VOID eliminate_common_subexpressions(struct IR *ir) {
+	compute_dominators(ir);
+	COUNT slots_count = 1024;
+	while (slots_count < ir->instructions_count * 2) slots_count *= 2;
+	IR_VALUE *slots = allocate_virtual_memory(slots_count * sizeof(IR_VALUE));
+	for (COUNT b = 1; b < ir->blocks_count; ++b) {
+		const struct IR_BLOCK *block = get_ir_block(b, ir);
+		if (b != 1 && !block->predecessors_count) continue;
+		for (IR_VALUE value = block->first; value < block->first + block->count; ++value) {
+			struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+			COUNT operands_count;
+			IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+			for (COUNT i = 0; i < operands_count; ++i)
+				operands[i] = resolve_ir_value(operands[i], ir);
+			if (instruction->opcode == OPCODE_undefined || (instruction->opcode >= OPCODES_COUNT && instruction->opcode != IR_OPCODE_constant && instruction->opcode != IR_OPCODE_check)) continue;
+			if (instruction->opcode < OPCODES_COUNT && is_commutative[instruction->opcode] && operands[0] > operands[1]) {
+				IR_VALUE swapped = operands[0];
+				operands[0] = operands[1];
+				operands[1] = swapped;
+			}
+			(VOID)number_ir_value(value, slots, slots_count, ir);
+		}
+	}
+	release_virtual_memory(slots, slots_count * sizeof(IR_VALUE));
+}
+
+/* whatever isn't reachable from a `yield`, `trap` or the control flow */
+static VOID eliminate_dead_code(struct IR *ir) {
+	SIZE size = ir->instructions_count * sizeof(IR_VALUE);
+	IR_VALUE *stack = allocate_virtual_memory(size);
+	BYTE *is_live = allocate_virtual_memory(ir->instructions_count);
+	COUNT stack_count = 0;
+	for (IR_VALUE value = 1; value < ir->instructions_count; ++value) {
+		switch (get_ir_instruction(value, ir)->opcode) {
+		case IR_OPCODE_yield:
+		case IR_OPCODE_trap:
+		case IR_OPCODE_jump:
+		case IR_OPCODE_branch:
+		case IR_OPCODE_check:
+			is_live[value] = 1;
+			stack[stack_count++] = value;
+			break;
+		default:
+			break;
+		}
+	}
+	while (stack_count) {
+		struct IR_INSTRUCTION *instruction = get_ir_instruction(stack[--stack_count], ir);
+		COUNT operands_count;
+		IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+		for (COUNT i = 0; i < operands_count; ++i) {
+			IR_VALUE operand = operands[i] = resolve_ir_value(operands[i], ir);
+			if (is_live[operand]) continue;
+			is_live[operand] = 1;
+			stack[stack_count++] = operand;
+		}
+	}
+	for (IR_VALUE value = 1; value < ir->instructions_count; ++value)
+		if (!is_live[value]) get_ir_instruction(value, ir)->opcode = OPCODE_undefined;
+	release_virtual_memory(stack, size);
+	release_virtual_memory(is_live, ir->instructions_count);
+}
+
+/* drops what's been removed or forwarded, and renumbers the rest in place */
+static VOID compact_ir(struct IR *ir) {
+	SIZE values_size = ir->instructions_count * sizeof(IR_VALUE), blocks_size = ir->blocks_count * sizeof(COUNT);
+	IR_VALUE *values = allocate_virtual_memory(values_size);
+	COUNT *blocks = allocate_virtual_memory(blocks_size);
+	COUNT instructions_count = 1, blocks_count = 1;
+	for (COUNT b = 1; b < ir->blocks_count; ++b) {
+		const struct IR_BLOCK *block = get_ir_block(b, ir);
+		if (b != 1 && !block->predecessors_count) continue;
+		blocks[b] = blocks_count++;
+		for (IR_VALUE value = block->first; value < block->first + block->count; ++value) {
+			struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+			if (instruction->opcode == OPCODE_undefined || instruction->opcode == IR_OPCODE_forward) continue;
+			COUNT operands_count;
+			IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+			for (COUNT i = 0; i < operands_count; ++i)
+				operands[i] = resolve_ir_value(operands[i], ir);
+			values[value] = instructions_count++;
+		}
+	}
+
+	for (COUNT b = 1; b < ir->blocks_count; ++b) {
+		if (!blocks[b]) continue;
+		struct IR_BLOCK block = *get_ir_block(b, ir);
+		COUNT first = block.first, count = block.count;
+		block.first = 0;
+		block.count = 0;
+		for (IR_VALUE value = first; value < first + count; ++value) {
+			if (!values[value]) continue;
+			struct IR_INSTRUCTION *instruction = get_ir_instruction(values[value], ir);
+			*instruction = *get_ir_instruction(value, ir);
+			instruction->block = blocks[b];
+			COUNT operands_count;
+			IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+			for (COUNT i = 0; i < operands_count; ++i) {
+				assert(values[operands[i]]);
+				operands[i] = values[operands[i]];
+			}
+			if (!block.count++) block.first = values[value];
+		}
+		if (!block.count) block.first = instructions_count;
+		COUNT *predecessors = get_predecessors(&block, ir);
+		for (COUNT i = 0; i < block.predecessors_count; ++i)
+			predecessors[i] = blocks[predecessors[i]];
+		for (COUNT i = 0; i < 2; ++i)
+			block.successors[i] = blocks[block.successors[i]];
+		*get_ir_block(blocks[b], ir) = block;
+	}
+	ir->instructions_count = instructions_count;
+	ir->blocks_count = blocks_count;
+	ir->instructions.data_size = instructions_count * sizeof(struct IR_INSTRUCTION);
+	ir->blocks.data_size = blocks_count * sizeof(struct IR_BLOCK);
+	release_virtual_memory(values, values_size);
+	release_virtual_memory(blocks, blocks_size);
+}
+
+struct IR_PASS {
+	CHAR name[32];
+	VOID (*procedure)(struct IR *ir);
+};
+
+static const struct IR_PASS ir_passes[] = {
+	{ "constant propagation",  propagate_constants            },
+	{ "common subexpressions", eliminate_common_subexpressions },
+	{ "dead code",             eliminate_dead_code            },
+};
+
+static VOID optimize_ir(struct IR *ir) {
+	for (COUNT i = 0; i < sizeof(ir_passes) / sizeof(ir_passes[0]); ++i) {
+		COUNT instructions_count = ir->instructions_count - 1, blocks_count = ir->blocks_count - 1;
+		SIZE counter = query_performance_counter();
+		ir_passes[i].procedure(ir);
+		compact_ir(ir);
+		F64 seconds = get_elapsed_seconds(counter);
+		report(SEVERITY_comment, 0, 0, "%-21s %7u -> %7u instructions, %6u -> %6u blocks in %.3f ms",
+			ir_passes[i].name, instructions_count, ir->instructions_count - 1, blocks_count, ir->blocks_count - 1, seconds * 1e3);
+	}
+}
+
+static VOID dump_ir(struct IR *ir) {
+	compute_dominators(ir);
+	for (COUNT b = 1; b < ir->blocks_count; ++b) {
+		const struct IR_BLOCK *block = get_ir_block(b, ir);
+		printf("block %u", b);
+		if (block->dominator) printf(", dominated by %u, from", block->dominator);
+		for (COUNT i = 0; i < block->predecessors_count; ++i)
+			printf(" %u", get_predecessors(block, ir)[i]);
+		printf(":\n");
+		for (IR_VALUE value = block->first; value < block->first + block->count; ++value) {
+			struct IR_INSTRUCTION *instruction = get_ir_instruction(value, ir);
+			COUNT operands_count;
+			IR_VALUE *operands = get_ir_operands(instruction, &operands_count, ir);
+			if (instruction->opcode < IR_OPCODE_yield) printf("\t%%%u = %s", value, string_from_ir_opcode[instruction->opcode]);
+			else printf("\t%s", string_from_ir_opcode[instruction->opcode]);
+			if (instruction->opcode == IR_OPCODE_constant && instruction->kind == KIND_real) printf(" %g", instruction->immediate.real);
+			else if (instruction->opcode == IR_OPCODE_constant) printf(" %llu", instruction->immediate.natural);
+			for (COUNT i = 0; i < operands_count; ++i)
+				printf(" %%%u", operands[i]);
+			if (instruction->opcode == IR_OPCODE_yield || instruction->opcode == IR_OPCODE_trap) printf(" (statement %llu)", instruction->immediate.natural);
+			if (instruction->opcode >= IR_OPCODE_jump) printf(" -> %u", block->successors[0]);
+			if (instruction->opcode >= IR_OPCODE_branch) printf(", %u", block->successors[1]);
+			printf("\n");
+		}
+	}
+}
+
+/*
+NOTE(Emhyr): the backend translates the bytecode to x86-64 in a single pass,
+without an assembler in between. the bytecode's registers are already
+allocated as a stack by depth, so the allocator is a fixed map: the first
+eleven go to machine registers, and the rest are spilled to the frame. every
+instruction loads its operands into `rax` and `rcx`, operates there, and
+stores `rax` back; `rdx` and the SSE registers are only scratch.
+
+for an object, all statements go into one function, `evaluate`, which runs
+them in order and returns the value of the last. each global declaration is a
+64-bit symbol of the same name in `.bss`, so a C program can link against the
+object. for the JIT, every statement is its own function, and a division by
+zero stores 1 to the globals' reserved slot and returns instead of faulting.
+
+`rsi` and `rdi` are saved along with the System V callee-saved registers, so
+the functions can be called with the Windows convention too.
+*/
+
+enum MACHINE_REGISTER {
+	MACHINE_REGISTER_rax,
+	MACHINE_REGISTER_rcx,
+	MACHINE_REGISTER_rdx,
+	MACHINE_REGISTER_rbx,
+	MACHINE_REGISTER_rsp,
+	MACHINE_REGISTER_rbp,
+	MACHINE_REGISTER_rsi,
+	MACHINE_REGISTER_rdi,
+	MACHINE_REGISTER_r8,
+	MACHINE_REGISTER_r9,
+	MACHINE_REGISTER_r10,
+	MACHINE_REGISTER_r11,
+	MACHINE_REGISTER_r12,
+	MACHINE_REGISTER_r13,
+	MACHINE_REGISTER_r14,
+	MACHINE_REGISTER_r15,
+};
+
+static const enum MACHINE_REGISTER machine_register_from_register[] = {
+	MACHINE_REGISTER_rsi, MACHINE_REGISTER_rdi, MACHINE_REGISTER_r8,  MACHINE_REGISTER_r9,
+	MACHINE_REGISTER_r10, MACHINE_REGISTER_r11, MACHINE_REGISTER_rbx, MACHINE_REGISTER_r12,
+	MACHINE_REGISTER_r13, MACHINE_REGISTER_r14, MACHINE_REGISTER_r15,
+};
+
+#define MACHINE_REGISTERS_COUNT (sizeof(machine_register_from_register) / sizeof(machine_register_from_register[0]))
+#define CALLEE_SAVED_SIZE (7 * 8) /* rbx, r12, r13, r14, r15, rsi and rdi, below rbp */
+
+/* a `rip`-relative reference to a global */
+struct MACHINE_RELOCATION {
+	COUNT offset;
+	COUNT declaration;
+};
+
+/* a jump to a bytecode instruction */
+struct MACHINE_FIXUP {
+	COUNT offset;
+	COUNT target;
+};
+
+struct MACHINE_CODE {
+	struct BUFFER text;
+	struct BUFFER relocations;
+	struct BUFFER fixups;
+	struct BUFFER traps; /* offsets of jumps to the trap */
+	COUNT relocations_count;
+	COUNT spills_count;
+	BOOLEAN is_guarded;
+};
+
+#define TRAP_DECLARATION 0
+
+/* for comparisons: the condition code of `setcc` */
+static const BYTE condition_from_opcode[OPCODES_COUNT] = {
+	[OPCODE_equality              ] = 0x94,
+	[OPCODE_inequality            ] = 0x95,
+	[OPCODE_greater               ] = 0x97,
+	[OPCODE_lesser                ] = 0x92,
+	[OPCODE_greater_equality      ] = 0x93,
+	[OPCODE_lesser_equality       ] = 0x96,
+	[OPCODE_real_greater          ] = 0x97,
+	[OPCODE_real_lesser           ] = 0x97, /* with the operands swapped */
+	[OPCODE_real_greater_equality ] = 0x93,
+	[OPCODE_real_lesser_equality  ] = 0x93, /* with the operands swapped */
+};
+
+/* for arithmetic: the opcode of `op rax, rcx`, or of `opsd xmm0, xmm1` */
+static const BYTE operation_from_opcode[OPCODES_COUNT] = {
+	[OPCODE_and                ] = 0x21,
+	[OPCODE_or                 ] = 0x09,
+	[OPCODE_xor                ] = 0x31,
+	[OPCODE_addition           ] = 0x01,
+	[OPCODE_subtraction        ] = 0x29,
+	[OPCODE_real_addition      ] = 0x58,
+	[OPCODE_real_subtraction   ] = 0x5c,
+	[OPCODE_real_multiplication] = 0x59,
+	[OPCODE_real_division      ] = 0x5e,
+};
+
+static inline VOID emit_code(const BYTE *bytes, SIZE size, struct MACHINE_CODE *code) {
+	copy(push(size, 1, &code->text), bytes, size);
+}
+
+#define EMIT(...) emit_code((const BYTE[]){ __VA_ARGS__ }, sizeof((const BYTE[]){ __VA_ARGS__ }), code)
+
+static inline VOID emit_code_word(U32 word, struct MACHINE_CODE *code) {
+	EMIT(word, word >> 8, word >> 16, word >> 24);
+}
+
+static inline COUNT get_code_size(const struct MACHINE_CODE *code) {
+	return code->text.data_size;
+}
+
+/* `mov scratch, r` when loading, and `mov r, scratch` otherwise */
+static VOID emit_transfer(BOOLEAN is_loading, enum MACHINE_REGISTER scratch, COUNT r, struct MACHINE_CODE *code) {
+	BYTE opcode = is_loading ? 0x8b : 0x89;
+	if (r < MACHINE_REGISTERS_COUNT) {
+		enum MACHINE_REGISTER other = machine_register_from_register[r];
+		EMIT(0x48 | other >> 3, opcode, 0xc0 | scratch << 3 | (other & 7));
+	} else {
+		EMIT(0x48, opcode, 0x80 | scratch << 3 | MACHINE_REGISTER_rbp);
+		emit_code_word(-(S32)(CALLEE_SAVED_SIZE + 8 * (r - MACHINE_REGISTERS_COUNT + 1)), code);
+	}
+}
+
+static inline VOID emit_global_reference(COUNT declaration, struct MACHINE_CODE *code) {
+	*(struct MACHINE_RELOCATION *)push(sizeof(struct MACHINE_RELOCATION), alignof(struct MACHINE_RELOCATION), &code->relocations) = (struct MACHINE_RELOCATION){ get_code_size(code), declaration };
+	++code->relocations_count;
+	emit_code_word(0, code);
+}
+
+static inline VOID emit_jump_target(COUNT target, struct MACHINE_CODE *code) {
+	*(struct MACHINE_FIXUP *)push(sizeof(struct MACHINE_FIXUP), alignof(struct MACHINE_FIXUP), &code->fixups) = (struct MACHINE_FIXUP){ get_code_size(code), target };
+	emit_code_word(0, code);
+}
+
+static inline VOID emit_trap_jump(struct MACHINE_CODE *code) {
+	*(COUNT *)push(sizeof(COUNT), alignof(COUNT), &code->traps) = get_code_size(code);
+	emit_code_word(0, code);
+}
+
+static VOID translate_instruction(const INSTRUCTION *ip, COUNT at, struct MACHINE_CODE *code) {
+	INSTRUCTION instruction = *ip;
+	enum OPCODE opcode = instruction & 0xff;
+	COUNT a = instruction >> 8 & 0xff, b = instruction >> 16 & 0xff, c = instruction >> 24;
+	switch (opcode) {
+	case OPCODE_return:
+		emit_transfer(1, MACHINE_REGISTER_rax, a, code);
+		return;
+	case OPCODE_load:
+		EMIT(0x48, 0xb8);
+		emit_code_word(ip[1], code);
+		emit_code_word(ip[2], code);
+		break;
+	case OPCODE_load_global:
+		EMIT(0x48, 0x8b, 0x05);
+		emit_global_reference(ip[1], code);
+		break;
+	case OPCODE_store_global:
+		emit_transfer(1, MACHINE_REGISTER_rax, a, code);
+		EMIT(0x48, 0x89, 0x05);
+		emit_global_reference(ip[1], code);
+		return;
+	case OPCODE_jump:
+		EMIT(0xe9);
+		emit_jump_target(at + 2 + ip[1], code);
+		return;
+	case OPCODE_jump_if_zero:
+	case OPCODE_jump_if_nonzero:
+		emit_transfer(1, MACHINE_REGISTER_rax, a, code);
+		EMIT(0x48, 0x85, 0xc0, 0x0f, opcode == OPCODE_jump_if_zero ? 0x84 : 0x85);
+		emit_jump_target(at + 2 + ip[1], code);
+		return;
+	case OPCODE_real_from_natural:
+		/* `cvtsi2sd` is signed, so halve what doesn't fit, rounding to odd, and double it back */
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x48, 0x85, 0xc0, 0x78, 0x07, 0xf2, 0x48, 0x0f, 0x2a, 0xc0, 0xeb, 0x15,
+		     0x48, 0x89, 0xc1, 0x48, 0xd1, 0xe9, 0x83, 0xe0, 0x01, 0x48, 0x09, 0xc1,
+		     0xf2, 0x48, 0x0f, 0x2a, 0xc1, 0xf2, 0x0f, 0x58, 0xc0,
+		     0x66, 0x48, 0x0f, 0x7e, 0xc0);
+		break;
+	case OPCODE_natural_from_real:
+		/* out of range, `cvttsd2si` gives the "integer indefinite"; that becomes 0 */
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x66, 0x48, 0x0f, 0x6e, 0xc0, 0xf2, 0x48, 0x0f, 0x2c, 0xc0,
+		     0x48, 0xb9, 0, 0, 0, 0, 0, 0, 0, 0x80, 0x48, 0x39, 0xc8, 0x75, 0x02, 0x31, 0xc0);
+		break;
+	case OPCODE_truth:
+	case OPCODE_negation:
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x48, 0x85, 0xc0, 0x0f, opcode == OPCODE_truth ? 0x95 : 0x94, 0xc0, 0x0f, 0xb6, 0xc0);
+		break;
+	case OPCODE_real_truth:
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x66, 0x48, 0x0f, 0x6e, 0xc0, 0x66, 0x0f, 0x57, 0xc9, 0x66, 0x0f, 0x2e, 0xc1,
+		     0x0f, 0x95, 0xc0, 0x0f, 0x9a, 0xc1, 0x08, 0xc8, 0x0f, 0xb6, 0xc0);
+		break;
+	case OPCODE_not:
+	case OPCODE_negative:
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x48, 0xf7, opcode == OPCODE_not ? 0xd0 : 0xd8);
+		break;
+	case OPCODE_real_negative:
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		EMIT(0x48, 0xb9, 0, 0, 0, 0, 0, 0, 0, 0x80, 0x48, 0x31, 0xc8);
+		break;
+	default:
+		emit_transfer(1, MACHINE_REGISTER_rax, b, code);
+		emit_transfer(1, MACHINE_REGISTER_rcx, c, code);
+		switch (opcode) {
+		case OPCODE_and:
+		case OPCODE_or:
+		case OPCODE_xor:
+		case OPCODE_addition:
+		case OPCODE_subtraction:
+			EMIT(0x48, operation_from_opcode[opcode], 0xc8);
+			break;
+		case OPCODE_multiplication:
+			EMIT(0x48, 0x0f, 0xaf, 0xc1);
+			break;
+		case OPCODE_lsh:
+		case OPCODE_rsh:
+			/* x86 masks the count, but shifting by 64 or more gives 0 here */
+			EMIT(0x31, 0xd2, 0x48, 0xd3, opcode == OPCODE_lsh ? 0xe0 : 0xe8, 0x48, 0x83, 0xf9, 0x40, 0x48, 0x0f, 0x43, 0xc2);
+			break;
+		case OPCODE_division:
+		case OPCODE_remainder:
+			/* dividing by zero raises #DE, unless guarded */
+			if (code->is_guarded) {
+				EMIT(0x48, 0x85, 0xc9, 0x0f, 0x84);
+				emit_trap_jump(code);
+			}
+			EMIT(0x31, 0xd2, 0x48, 0xf7, 0xf1);
+			if (opcode == OPCODE_remainder) EMIT(0x48, 0x89, 0xd0);
+			break;
+		case OPCODE_equality ... OPCODE_lesser_equality:
+			EMIT(0x48, 0x39, 0xc8, 0x0f, condition_from_opcode[opcode], 0xc0, 0x0f, 0xb6, 0xc0);
+			break;
+		case OPCODE_real_addition ... OPCODE_real_division:
+			EMIT(0x66, 0x48, 0x0f, 0x6e, 0xc0, 0x66, 0x48, 0x0f, 0x6e, 0xc9);
+			/* dividing by zero (but not by NaN) executes `ud2`, unless guarded */
+			if (opcode == OPCODE_real_division) {
+				EMIT(0x66, 0x0f, 0x57, 0xd2, 0x66, 0x0f, 0x2e, 0xca);
+				if (code->is_guarded) {
+					EMIT(0x7a, 0x06, 0x0f, 0x84);
+					emit_trap_jump(code);
+				} else EMIT(0x7a, 0x04, 0x75, 0x02, 0x0f, 0x0b);
+			}
+			EMIT(0xf2, 0x0f, operation_from_opcode[opcode], 0xc1, 0x66, 0x48, 0x0f, 0x7e, 0xc0);
+			break;
+		case OPCODE_real_equality:
+		case OPCODE_real_inequality:
+			/* unordered sets ZF and PF; NaN is equal to nothing */
+			EMIT(0x66, 0x48, 0x0f, 0x6e, 0xc0, 0x66, 0x48, 0x0f, 0x6e, 0xc9, 0x66, 0x0f, 0x2e, 0xc1);
+			if (opcode == OPCODE_real_equality) EMIT(0x0f, 0x94, 0xc0, 0x0f, 0x9b, 0xc1, 0x20, 0xc8);
+			else EMIT(0x0f, 0x95, 0xc0, 0x0f, 0x9a, 0xc1, 0x08, 0xc8);
+			EMIT(0x0f, 0xb6, 0xc0);
+			break;
+		case OPCODE_real_greater ... OPCODE_real_lesser_equality:
+			EMIT(0x66, 0x48, 0x0f, 0x6e, 0xc0, 0x66, 0x48, 0x0f, 0x6e, 0xc9, 0x66, 0x0f, 0x2e);
+			EMIT(opcode == OPCODE_real_lesser || opcode == OPCODE_real_lesser_equality ? 0xc8 : 0xc1);
+			EMIT(0x0f, condition_from_opcode[opcode], 0xc0, 0x0f, 0xb6, 0xc0);
+			break;
+		default:
+			assert(0);
+		}
+		break;
+	}
+	emit_transfer(0, MACHINE_REGISTER_rax, a, code);
+}
+
+static inline COUNT get_instruction_size(enum OPCODE opcode) {
+	switch (opcode) {
+	case OPCODE_load:            return 3;
+	case OPCODE_load_global:
+	case OPCODE_store_global:
+	case OPCODE_jump:
+	case OPCODE_jump_if_zero:
+	case OPCODE_jump_if_nonzero: return 2;
+	default:                     return 1;
+	}
+}
+
+static VOID begin_function(struct MACHINE_CODE *code) {
+	/* push rbp; mov rbp, rsp; push rbx; push r12; push r13; push r14; push r15; push rsi; push rdi; sub rsp, spills; xor eax, eax */
+	EMIT(0x55, 0x48, 0x89, 0xe5, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57, 0x56, 0x57, 0x48, 0x81, 0xec);
+	emit_code_word(align_forwards(code->spills_count * 8, 16), code);
+	EMIT(0x31, 0xc0);
+}
+
+static VOID translate_chunk(const struct BYTECODE *bytecode, const struct CHUNK *chunk, COUNT *offsets, struct MACHINE_CODE *code) {
+	const INSTRUCTION *instructions = bytecode->instructions.data;
+	COUNT at = chunk->offset;
+	enum OPCODE opcode;
+	do {
+		opcode = instructions[at] & 0xff;
+		offsets[at] = get_code_size(code);
+		translate_instruction(&instructions[at], at, code);
+		at += get_instruction_size(opcode);
+	} while (opcode != OPCODE_return);
+	offsets[at] = get_code_size(code);
+}
+
+static VOID end_function(const COUNT *offsets, struct MACHINE_CODE *code) {
+	for (struct MACHINE_FIXUP *fixup = code->fixups.data; (BYTE *)fixup < (BYTE *)code->fixups.data + code->fixups.data_size; ++fixup) {
+		S32 displacement = offsets[fixup->target] - (fixup->offset + 4);
+		copy((BYTE *)code->text.data + fixup->offset, &displacement, sizeof(displacement));
+	}
+	code->fixups.data_size = 0;
+
+	/* lea rsp, [rbp - 56]; pop rdi; pop rsi; pop r15; pop r14; pop r13; pop r12; pop rbx; pop rbp; ret */
+	COUNT epilogue = get_code_size(code);
+	EMIT(0x48, 0x8d, 0x65, -CALLEE_SAVED_SIZE, 0x5f, 0x5e, 0x41, 0x5f, 0x41, 0x5e, 0x41, 0x5d, 0x41, 0x5c, 0x5b, 0x5d, 0xc3);
+	if (!code->traps.data_size) return;
+
+	/* mov eax, 1; mov [trap], rax; jmp epilogue */
+	for (COUNT *trap = code->traps.data; (BYTE *)trap < (BYTE *)code->traps.data + code->traps.data_size; ++trap) {
+		S32 displacement = get_code_size(code) - (*trap + 4);
+		copy((BYTE *)code->text.data + *trap, &displacement, sizeof(displacement));
+	}
+	code->traps.data_size = 0;
+	EMIT(0xb8, 1, 0, 0, 0, 0x48, 0x89, 0x05);
+	emit_global_reference(TRAP_DECLARATION, code);
+	EMIT(0xe9);
+	emit_code_word(epilogue - (get_code_size(code) + 4), code);
+}
+
+/* when `entries` is given, every statement becomes its own function, guarded and starting at its entry */
+static VOID generate_machine_code(const struct BYTECODE *bytecode, COUNT statements_count, COUNT *entries, struct MACHINE_CODE *code) {
+	COUNT registers_count = 0;
+	for (COUNT i = 0; i < statements_count; ++i)
+		if (bytecode->chunks[i].offset != NO_CHUNK && bytecode->chunks[i].registers_count > registers_count) registers_count = bytecode->chunks[i].registers_count;
+	code->spills_count = registers_count > MACHINE_REGISTERS_COUNT ? registers_count - MACHINE_REGISTERS_COUNT : 0;
+	code->is_guarded = entries != 0;
+
+	SIZE offsets_size = (get_instructions_count(bytecode) + 1) * sizeof(COUNT);
+	COUNT *offsets = allocate_virtual_memory(offsets_size);
+	if (!entries) begin_function(code);
+	for (COUNT i = 0; i < statements_count; ++i) {
+		const struct CHUNK *chunk = &bytecode->chunks[i];
+		if (entries) entries[i] = chunk->offset == NO_CHUNK ? NO_CHUNK : get_code_size(code);
+		if (chunk->offset == NO_CHUNK) continue;
+		if (entries) begin_function(code);
+		translate_chunk(bytecode, chunk, offsets, code);
+		if (entries) end_function(offsets, code);
+	}
+	if (!entries) end_function(offsets, code);
+	release_virtual_memory(offsets, offsets_size);
+}
+
+static VOID release_machine_code(struct MACHINE_CODE *code) {
+	release_virtual_memory(code->text.data, code->text.reservation_size);
+	if (code->relocations.data) release_virtual_memory(code->relocations.data, code->relocations.reservation_size);
+	if (code->fixups.data) release_virtual_memory(code->fixups.data, code->fixups.reservation_size);
+	if (code->traps.data) release_virtual_memory(code->traps.data, code->traps.reservation_size);
+}
+
+/*
+NOTE(Emhyr): the JIT maps the code and the globals together, with the globals
+on their own pages after the code, so every `rip`-relative reference is in
+range. the code is written, resolved and then flipped to executable; it's
+never writable and executable at once.
+*/
+
+typedef U64 MACHINE_FUNCTION(VOID);
+
+struct JIT {
+	BYTE *memory;
+	SIZE code_size;
+	SIZE memory_size;
+	union VALUE *globals;
+};
+
+static VOID load_machine_code(const struct MACHINE_CODE *code, COUNT declarations_count, struct JIT *jit) {
+	SIZE page_size = query_system_page_size();
+	jit->code_size = align_forwards(get_code_size(code), page_size);
+	jit->memory_size = jit->code_size + align_forwards((declarations_count + 1) * sizeof(union VALUE), page_size);
+	jit->memory = allocate_virtual_memory(jit->memory_size);
+	jit->globals = (union VALUE *)(jit->memory + jit->code_size);
+	copy(jit->memory, code->text.data, get_code_size(code));
+	for (const struct MACHINE_RELOCATION *relocation = code->relocations.data; relocation < (const struct MACHINE_RELOCATION *)code->relocations.data + code->relocations_count; ++relocation) {
+		S32 displacement = (BYTE *)&jit->globals[relocation->declaration] - (jit->memory + relocation->offset + 4);
+		copy(jit->memory + relocation->offset, &displacement, sizeof(displacement));
+	}
+	protect_virtual_memory(jit->memory, jit->code_size, 1);
+}
+
+/* returns 0 if the function trapped */
+static inline BOOLEAN run_machine_code(COUNT entry, const struct JIT *jit, union VALUE *result) {
+	jit->globals[TRAP_DECLARATION].natural = 0;
+	result->natural = ((MACHINE_FUNCTION *)(jit->memory + entry))();
+	return !jit->globals[TRAP_DECLARATION].natural;
+}
+
+static VOID unload_machine_code(struct JIT *jit) {
+	release_virtual_memory(jit->memory, jit->memory_size);
+}
+
+#undef EMIT
+
+/*
+NOTE(Emhyr): the object has the sections `.text`, `.bss`, `.symtab`,
+`.strtab`, `.rela.text`, `.shstrtab` and an empty `.note.GNU-stack` (so the
+linker doesn't make the stack executable). every symbol is global, and each
+global is referenced `rip`-relative with `R_X86_64_PC32`.
+*/
+
+struct ELF_HEADER {
+	BYTE identification[16];
+	U16 type;
+	U16 machine;
+	U32 version;
+	U64 entry;
+	U64 program_headers_offset;
+	U64 section_headers_offset;
+	U32 flags;
+	U16 header_size;
+	U16 program_header_size;
+	U16 program_headers_count;
+	U16 section_header_size;
+	U16 section_headers_count;
+	U16 section_names_index;
+};
+
+struct ELF_SECTION_HEADER {
+	U32 name;
+	U32 type;
+	U64 flags;
+	U64 address;
+	U64 offset;
+	U64 size;
+	U32 link;
+	U32 info;
+	U64 alignment;
+	U64 entry_size;
+};
+
+struct ELF_SYMBOL {
+	U32 name;
+	BYTE info;
+	BYTE other;
+	U16 section_index;
+	U64 value;
+	U64 size;
+};
+
+struct ELF_RELOCATION {
+	U64 offset;
+	U64 info;
+	S64 addend;
+};
+
+enum ELF_SECTION {
+	ELF_SECTION_null,
+	ELF_SECTION_text,
+	ELF_SECTION_bss,
+	ELF_SECTION_symtab,
+	ELF_SECTION_strtab,
+	ELF_SECTION_rela_text,
+	ELF_SECTION_shstrtab,
+	ELF_SECTION_note_gnu_stack,
+
+	ELF_SECTIONS_COUNT,
+};
+
+static const CHAR string_from_elf_section[ELF_SECTIONS_COUNT][16] = {
+	[ELF_SECTION_null          ] = "",
+	[ELF_SECTION_text          ] = ".text",
+	[ELF_SECTION_bss           ] = ".bss",
+	[ELF_SECTION_symtab        ] = ".symtab",
+	[ELF_SECTION_strtab        ] = ".strtab",
+	[ELF_SECTION_rela_text     ] = ".rela.text",
+	[ELF_SECTION_shstrtab      ] = ".shstrtab",
+	[ELF_SECTION_note_gnu_stack] = ".note.GNU-stack",
+};
+
+#define ENTRY_NAME "evaluate"
+
+static inline SIZE push_elf_data(const VOID *data, SIZE size, SIZE alignment, C_BUFFER *buffer) {
+	VOID *destination = push(size, alignment, buffer);
+	if (size) copy(destination, data, size);
+	return (BYTE *)destination - (BYTE *)buffer->data;
+}
+
+static VOID write_object(const CHAR *path, const struct MACHINE_CODE *code, const struct DECLARATIONS *declarations) {
+	struct BUFFER file = DEFAULT_BUFFER, symbols = DEFAULT_BUFFER, strings = DEFAULT_BUFFER, relocations = DEFAULT_BUFFER, section_names = DEFAULT_BUFFER;
+	COUNT *symbol_from_declaration = allocate_virtual_memory((declarations->declarations_count + 1) * sizeof(COUNT));
+
+	(VOID)push(1, 1, &strings);
+	(VOID)push(sizeof(struct ELF_SYMBOL), alignof(struct ELF_SYMBOL), &symbols);
+	*(struct ELF_SYMBOL *)push(sizeof(struct ELF_SYMBOL), alignof(struct ELF_SYMBOL), &symbols) = (struct ELF_SYMBOL){
+		.name          = push_elf_data(ENTRY_NAME, sizeof(ENTRY_NAME), 1, &strings),
+		.info          = 1 << 4 | 2, /* STB_GLOBAL, STT_FUNC */
+		.section_index = ELF_SECTION_text,
+		.size          = get_code_size(code),
+	};
+	COUNT symbols_count = 2;
+	for (COUNT i = 1; i <= declarations->declarations_count; ++i) {
+		const struct DECLARATION *declaration = get_declaration(i, declarations);
+		if (declaration->scope) continue;
+		COUNT size;
+		const CHAR *text = get_symbol_text(declaration->name, &size, declarations->interner);
+		if (size == sizeof(ENTRY_NAME) - 1 && !__builtin_memcmp(text, ENTRY_NAME, size)) fail(0, 0, "`%s` is reserved for the entry", ENTRY_NAME);
+		U32 name = push_elf_data(text, size, 1, &strings);
+		(VOID)push(1, 1, &strings);
+		*(struct ELF_SYMBOL *)push(sizeof(struct ELF_SYMBOL), alignof(struct ELF_SYMBOL), &symbols) = (struct ELF_SYMBOL){
+			.name          = name,
+			.info          = 1 << 4 | 1, /* STB_GLOBAL, STT_OBJECT */
+			.section_index = ELF_SECTION_bss,
+			.value         = 8 * i,
+			.size          = 8,
+		};
+		symbol_from_declaration[i] = symbols_count++;
+	}
+	for (const struct MACHINE_RELOCATION *relocation = code->relocations.data; relocation < (const struct MACHINE_RELOCATION *)code->relocations.data + code->relocations_count; ++relocation) {
+		*(struct ELF_RELOCATION *)push(sizeof(struct ELF_RELOCATION), alignof(struct ELF_RELOCATION), &relocations) = (struct ELF_RELOCATION){
+			.offset = relocation->offset,
+			.info   = (U64)symbol_from_declaration[relocation->declaration] << 32 | 2, /* R_X86_64_PC32 */
+			.addend = -4,
+		};
+	}
+	U32 section_name_offsets[ELF_SECTIONS_COUNT];
+	for (COUNT i = 0; i < ELF_SECTIONS_COUNT; ++i)
+		section_name_offsets[i] = push_elf_data(string_from_elf_section[i], get_size_of_string(string_from_elf_section[i]) + 1, 1, &section_names);
+
+	(VOID)push(sizeof(struct ELF_HEADER), alignof(struct ELF_HEADER), &file);
+	SIZE text_offset          = push_elf_data(code->text.data, code->text.data_size, 16, &file);
+	SIZE symbols_offset       = push_elf_data(symbols.data, symbols.data_size, 8, &file);
+	SIZE strings_offset       = push_elf_data(strings.data, strings.data_size, 1, &file);
+	SIZE relocations_offset   = push_elf_data(relocations.data, relocations.data_size, 8, &file);
+	SIZE section_names_offset = push_elf_data(section_names.data, section_names.data_size, 1, &file);
+	struct ELF_SECTION_HEADER *sections = push(ELF_SECTIONS_COUNT * sizeof(struct ELF_SECTION_HEADER), 8, &file);
+	sections[ELF_SECTION_text          ] = (struct ELF_SECTION_HEADER){ .type = 1, .flags = 0x2 | 0x4, .offset = text_offset, .size = code->text.data_size, .alignment = 16 };
+	sections[ELF_SECTION_bss           ] = (struct ELF_SECTION_HEADER){ .type = 8, .flags = 0x1 | 0x2, .offset = text_offset, .size = 8 * (declarations->declarations_count + 1), .alignment = 8 };
+	sections[ELF_SECTION_symtab        ] = (struct ELF_SECTION_HEADER){ .type = 2, .offset = symbols_offset, .size = symbols.data_size, .link = ELF_SECTION_strtab, .info = 1, .alignment = 8, .entry_size = sizeof(struct ELF_SYMBOL) };
+	sections[ELF_SECTION_strtab        ] = (struct ELF_SECTION_HEADER){ .type = 3, .offset = strings_offset, .size = strings.data_size, .alignment = 1 };
+	sections[ELF_SECTION_rela_text     ] = (struct ELF_SECTION_HEADER){ .type = 4, .flags = 0x40, .offset = relocations_offset, .size = relocations.data_size, .link = ELF_SECTION_symtab, .info = ELF_SECTION_text, .alignment = 8, .entry_size = sizeof(struct ELF_RELOCATION) };
+	sections[ELF_SECTION_shstrtab      ] = (struct ELF_SECTION_HEADER){ .type = 3, .offset = section_names_offset, .size = section_names.data_size, .alignment = 1 };
+	sections[ELF_SECTION_note_gnu_stack] = (struct ELF_SECTION_HEADER){ .type = 1, .offset = section_names_offset, .alignment = 1 };
+	for (COUNT i = 0; i < ELF_SECTIONS_COUNT; ++i)
+		sections[i].name = section_name_offsets[i];
+
+	*(struct ELF_HEADER *)file.data = (struct ELF_HEADER){
+		.identification         = { 0x7f, 'E', 'L', 'F', 2, 1, 1 }, /* 64-bit, little-endian, version 1, System V */
+		.type                   = 1,  /* ET_REL */
+		.machine                = 62, /* EM_X86_64 */
+		.version                = 1,
+		.section_headers_offset = (BYTE *)sections - (BYTE *)file.data,
+		.header_size            = sizeof(struct ELF_HEADER),
+		.section_header_size    = sizeof(struct ELF_SECTION_HEADER),
+		.section_headers_count  = ELF_SECTIONS_COUNT,
+		.section_names_index    = ELF_SECTION_shstrtab,
+	};
+
+	HANDLE handle = create_file(path);
+	(VOID)write_to_file(file.data, file.data_size, handle);
+	close_file(handle);
+
+	release_virtual_memory(symbol_from_declaration, (declarations->declarations_count + 1) * sizeof(COUNT));
+	release_virtual_memory(file.data, file.reservation_size);
+	release_virtual_memory(symbols.data, symbols.reservation_size);
+	release_virtual_memory(strings.data, strings.reservation_size);
+	if (relocations.data) release_virtual_memory(relocations.data, relocations.reservation_size);
+	release_virtual_memory(section_names.data, section_names.reservation_size);
+}
+
+/* `<object>.fingerprint` is only rewritten when it changes, so that its time can tell a build whether to go on */
+static VOID write_fingerprint(const CHAR *object_path, U64 fingerprint) {
+	static const CHAR extension[] = ".fingerprint";
+	CHAR path[MAXIMUM_PATH_SIZE + sizeof(extension)];
+	SIZE path_size = get_size_of_string(object_path);
+	if (path_size > MAXIMUM_PATH_SIZE) fail(0, 0, "the path is too long: %s", object_path);
+	copy(path, object_path, path_size);
+	copy(path + path_size, extension, sizeof(extension));
+
+	CHAR text[17], existing_text[sizeof(text) + 1];
+	for (COUNT i = 0; i < 16; ++i)
+		text[i] = "0123456789abcdef"[fingerprint >> (60 - i * 4) & 0xf];
+	text[16] = '\n';
+	HANDLE file = open_file(path);
+	if (file != -1) {
+		SIZE existing_size = read_from_file(existing_text, sizeof(existing_text), file);
+		close_file(file);
+		if (existing_size == sizeof(text) && !__builtin_memcmp(existing_text, text, sizeof(text))) return;
+	}
+	file = create_file(path);
+	(VOID)write_to_file(text, sizeof(text), file);
+	close_file(file);
+}
+
+/*
+NOTE(Emhyr): the gate guards the front end against slowdowns that nothing else
+would notice. it scans and parses each source on one thread, and compares what
+it measured with the baselines. it measures the bytes it parsed per second, the
+instructions and cache misses it counted (when the platform can count them),
+and the peak of its arenas. a measurement that's worse than its baseline by
+more than the threshold fails the gate.
+
+time is noisy on a busy machine, so when instructions are counted, they're
+gated on instead of it. cache misses are only reported, because they're noisy
+too. the peak is the same on every run, so it's always gated on.
+
+besides the sources that are given, a few are generated, which are the same on
+every machine: random expressions, deep nesting and strings with escapes. before
+any of them, the front end's growth is checked with pathological sources.
+
+the baselines are a line for each source:
+	<name> <bytes per second> <instructions> <cache misses> <peak size>
+a field is `-` if it isn't measured: instructions and cache misses on a
+platform that can't count them, or the time in baselines that are shared
+between machines, since it's only comparable on the same one. that's kept in
+the machine's own baselines instead, which have only the time, and which the
+first gate to run on the machine records. a source fails the gate if it has no
+baseline, no peak, or neither instructions that can be compared nor a time.
+the baselines of the generated sources and of the samples in `tests` are in
+`tests/baselines.txt`, and the build gates on them, with the machine's in
+`build`.
+*/
+
+#define GENERATED_SOURCE_SIZE MEBIBYTES(1)
+#define DEFAULT_THRESHOLD     10 /* percent */
+#define UNMEASURED            ((U64)-1)
+
+struct MEASUREMENT {
+	CHAR name[MAXIMUM_PATH_SIZE + 1];
+	U64 bytes_per_second;
+	U64 instructions_count; /* `UNMEASURED` if they can't be counted */
+	U64 cache_misses_count;
+	U64 peak_size;
+};
+
+static VOID append_text(const CHAR *text, struct BUFFER *buffer) {
+	SIZE size = get_size_of_string(text);
+	copy(push(size, 1, buffer), text, size);
+}
+
+static VOID append_natural(U64 natural, struct BUFFER *buffer) {
+	CHAR digits[20];
+	COUNT digits_count = 0;
+	do digits[sizeof(digits) - ++digits_count] = '0' + natural % 10;
+	while (natural /= 10);
+	copy(push(digits_count, 1, buffer), digits + sizeof(digits) - digits_count, digits_count);
+}
+
+/* #recursive */
+static VOID generate_expression(COUNT depth, U64 *random, struct BUFFER *text) {
+	static const CHAR operators[][4] = { "+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>", "<", "<=", ">", ">=", "==", "!=", "&&", "||" };
+	static const CHAR unary_operators[][2] = { "-", "!", "~" };
+	U64 choice = generate_random(random);
+	if (!depth || choice % 3 == 0) {
+		switch (choice >> 8 & 3) {
+		case 0:
+			append_text("v", text);
+			append_natural(choice >> 16 & 0xff, text);
+			break;
+		case 1:
+			append_natural(choice >> 16 & 0xffff, text);
+			break;
+		case 2:
+			append_natural(choice >> 16 & 0xff, text);
+			append_text(".5", text);
+			break;
+		case 3:
+			append_text("\"s\\\"\\\\\"", text);
+			break;
+		}
+		return;
+	}
+	switch (choice >> 8 & 3) {
+	case 0:
+		append_text(unary_operators[(choice >> 16) % (sizeof(unary_operators) / sizeof(unary_operators[0]))], text);
+		generate_expression(depth - 1, random, text);
+		break;
+	case 1:
+		append_text("(", text);
+		generate_expression(depth - 1, random, text);
+		append_text(" ? ", text);
+		generate_expression(depth - 1, random, text);
+		append_text(" ! ", text);
+		generate_expression(depth - 1, random, text);
+		append_text(")", text);
+		break;
+	default:
+		append_text("(", text);
+		generate_expression(depth - 1, random, text);
+		append_text(" ", text);
+		append_text(operators[(choice >> 16) % (sizeof(operators) / sizeof(operators[0]))], text);
+		append_text(" ", text);
+		generate_expression(depth - 1, random, text);
+		append_text(")", text);
+		break;
+	}
+}
+
+static const CHAR generated_source_names[][32] = { "generated expressions", "generated nesting", "generated strings" };
+
+/* the source's data is the text's, which is padded like a loaded source's */
+static struct SOURCE generate_source(COUNT index, struct BUFFER *text) {
+	enum { NESTING_DEPTH = 256 };
+	U64 random = 0x9e3779b97f4a7c15 + index;
+	for (COUNT i = 0; text->data_size < GENERATED_SOURCE_SIZE; ++i) {
+		append_text("v", text);
+		append_natural(i & 0xff, text);
+		append_text(" : int = ", text);
+		switch (index) {
+		case 0:
+			generate_expression(6, &random, text);
+			break;
+		case 1:
+			for (COUNT j = 0; j < NESTING_DEPTH; ++j) append_text("(", text);
+			append_natural(i, text);
+			for (COUNT j = 0; j < NESTING_DEPTH; ++j) append_text(")", text);
+			break;
+		case 2:
+			append_text("\"", text);
+			for (COUNT j = generate_random(&random) % 64; j--;) {
+				static const CHAR pieces[][8] = { "a", "bc", "\\\"", "\\\\", "\\n", "\xc3\xa9", "\xe6\x97\xa5\xe6\x9c\xac", "[(", " " };
+				append_text(pieces[generate_random(&random) % (sizeof(pieces) / sizeof(pieces[0]))], text);
+			}
+			append_text("\" + v0", text);
+			break;
+		}
+		append_text(";\n", text);
+	}
+	struct SOURCE source = { 0 };
+	copy(source.path, generated_source_names[index], get_size_of_string(generated_source_names[index]));
+	source.size = text->data_size;
+	(VOID)push(sizeof(UTF32), 1, text);
+	source.data = text->data;
+	return source;
+}
+
+/* if it isn't parsing, it only lexes each statement, so that sources that can't be parsed can be measured too */
+/* how far into the front end a source is taken */
+enum STAGE {
+	STAGE_lexing,
+	STAGE_parsing,
+	STAGE_compiling, /* folding, analyzing, checking and compiling into bytecode */
+};
+
+static struct MEASUREMENT measure_front_end(const struct SOURCE *source, enum STAGE stage, const HANDLE counters[2]) {
+	/* a small source is parsed until enough time's passed for its best time to mean something */
+	enum { MINIMUM_RUNS_COUNT = 5, MAXIMUM_RUNS_COUNT = 10000 };
+	const F64 minimum_seconds = 0.05;
+	struct MEASUREMENT measurement = { 0 };
+	copy(measurement.name, source->path, get_size_of_string(source->path));
+	F64 best_seconds = 1e300, total_seconds = 0;
+	for (COUNT run = 0; run < MINIMUM_RUNS_COUNT || (total_seconds < minimum_seconds && run < MAXIMUM_RUNS_COUNT); ++run) {
+		struct BUFFER statements = DEFAULT_BUFFER;
+		COUNT next_statement = 0;
+		struct WORKER worker = {
+			.buffer         = DEFAULT_BUFFER,
+			.source         = source,
+			.next_statement = &next_statement,
+		};
+		U64 instructions_count = counters[0] != -1 ? read_event_counter(counters[0]) : 0;
+		U64 cache_misses_count = counters[1] != -1 ? read_event_counter(counters[1]) : 0;
+		SIZE counter = query_performance_counter();
+		worker.statements_count = scan_statements(source, &statements);
+		worker.statements = statements.data;
+		if (stage != STAGE_lexing) (VOID)parse_statements(&worker);
+		else for (COUNT i = 0; i < worker.statements_count; ++i) {
+			struct LEXER lexer = create_lexer(source, &worker.statements[i].range);
+			while (lex(&lexer).tag != TOKEN_TAG_terminator);
+		}
+		struct INTERNER interner = { 0 };
+		struct TYPES types = { .lengths.interner = &interner, .interner = &interner };
+		struct DECLARATIONS declarations = { .interner = &interner };
+		struct BYTECODE bytecode = { .instructions = DEFAULT_BUFFER };
+		struct BUFFER checker = DEFAULT_BUFFER;
+		SIZE checker_peak_size = 0;
+		if (stage == STAGE_compiling) {
+			analyze_statements(source, worker.statements, worker.statements_count, &types, &declarations);
+			struct CHECKER_WORKER *checker_worker = check_statements(worker.statements, worker.statements_count, &declarations, 1, 0, &checker);
+			compile_statements(worker.statements, worker.statements_count, &declarations, &bytecode);
+			checker_peak_size = checker_worker->buffer.peak_size;
+			if (checker_worker->buffer.data) release_virtual_memory(checker_worker->buffer.data, checker_worker->buffer.reservation_size);
+		}
+		F64 seconds = get_elapsed_seconds(counter);
+		if (counters[0] != -1) instructions_count = read_event_counter(counters[0]) - instructions_count;
+		if (counters[1] != -1) cache_misses_count = read_event_counter(counters[1]) - cache_misses_count;
+
+		total_seconds += seconds;
+		if (seconds < best_seconds) best_seconds = seconds;
+		if (!run || instructions_count < measurement.instructions_count) measurement.instructions_count = instructions_count;
+		if (!run || cache_misses_count < measurement.cache_misses_count) measurement.cache_misses_count = cache_misses_count;
+		measurement.peak_size = statements.peak_size + worker.buffer.peak_size + worker.stack_peak_size;
+		if (stage == STAGE_compiling) {
+			measurement.peak_size += interner.texts.peak_size + types.types.peak_size + declarations.declarations.peak_size + checker.peak_size + checker_peak_size + bytecode.instructions.peak_size;
+			release_bytecode(worker.statements_count, &bytecode);
+			if (bytecode.instructions.data) release_virtual_memory(bytecode.instructions.data, bytecode.instructions.reservation_size);
+			release_virtual_memory(checker.data, checker.reservation_size);
+			release_analysis(&types, &declarations);
+			release_interner(&interner);
+		}
+		if (worker.buffer.data) release_virtual_memory(worker.buffer.data, worker.buffer.reservation_size);
+		if (statements.data) release_virtual_memory(statements.data, statements.reservation_size);
+	}
+	measurement.bytes_per_second = source->size / best_seconds;
+	if (counters[0] == -1) measurement.instructions_count = UNMEASURED;
+	if (counters[1] == -1) measurement.cache_misses_count = UNMEASURED;
+	return measurement;
+}
+
+/* returns 0 if the line isn't a baseline, and points `*line` at the next line */
+static BOOLEAN parse_baseline(const CHAR **line, const CHAR *ending, struct MEASUREMENT *baseline) {
+	*baseline = (struct MEASUREMENT){ 0 };
+	const CHAR *beginning = *line, *line_ending = beginning;
+	while (line_ending < ending && *line_ending != '\n') ++line_ending;
+	*line = line_ending + (line_ending < ending);
+	while (line_ending > beginning && (line_ending[-1] == '\r' || line_ending[-1] == ' ')) --line_ending;
+
+	/* names have spaces, so the fields are found from the end */
+	U64 *fields[] = { &baseline->peak_size, &baseline->cache_misses_count, &baseline->instructions_count, &baseline->bytes_per_second };
+	const CHAR *field_ending = line_ending;
+	for (COUNT i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+		const CHAR *field_beginning = field_ending;
+		if (field_beginning > beginning && field_beginning[-1] == '-') {
+			*fields[i] = UNMEASURED;
+			--field_beginning;
+		} else {
+			while (field_beginning > beginning && field_beginning[-1] >= '0' && field_beginning[-1] <= '9') --field_beginning;
+			if (field_beginning == field_ending) return 0;
+			for (const CHAR *digit = field_beginning; digit < field_ending; ++digit) *fields[i] = *fields[i] * 10 + (*digit - '0');
+		}
+		field_ending = field_beginning;
+		while (field_ending > beginning && field_ending[-1] == ' ') --field_ending;
+	}
+	if (field_ending == beginning || field_ending - beginning > MAXIMUM_PATH_SIZE) return 0;
+	copy(baseline->name, beginning, field_ending - beginning);
+	return 1;
+}
+
+/* returns 1 if it regressed */
+static COUNT compare_measurement(const CHAR *name, const CHAR *unit, U64 measured, U64 baseline, BOOLEAN is_more_better, U64 threshold) {
+	if (!baseline) return 0;
+	assert(measured != UNMEASURED && baseline != UNMEASURED);
+	F64 change = ((F64)measured - (F64)baseline) / (F64)baseline * 100;
+	if (is_more_better ? change >= -(F64)threshold : change <= (F64)threshold) return 0;
+	report(SEVERITY_caution, 0, 0, "%s regressed to %llu %s from %llu (%+.1f%%)", name, measured, unit, baseline, change);
+	return 1;
+}
+
+/*
+NOTE(Emhyr): the front end must take linear time and memory in its source,
+whatever's in it, so that a hostile or broken generator can't stall it. each
+kind of pathological source is generated at sizes from the smallest to the
+largest, and the time and the peak for each byte at the largest are compared
+with those at the smallest. they'd grow with the size if something's
+superlinear, by a lot more than noise does. a chain or a nesting is one
+statement that's as long or as deep as the size makes it, so that it's what
+grows instead of how many times it's repeated.
+
+every source that parses is compiled as well, so that folding, analyzing and
+checking are held to the same. the chains and the nestings are of constants,
+which are folded into a literal before anything could recurse over them, so
+the deepest trees that the later passes take are chains of references, each as
+deep as `MAXIMUM_TREE_DEPTH` lets them be, repeated up to the size. an
+unterminated string can't be parsed, so it's only lexed.
+*/
+
+#define SMALLEST_GROWTH_SIZE KIBIBYTES(64)
+#define LARGEST_GROWTH_SIZE  MEBIBYTES(1)
+#define MAXIMUM_TIME_GROWTH  4 /* times, for each byte */
+#define MAXIMUM_PEAK_GROWTH  2
+
+static const struct {
+	CHAR name[32];
+	enum STAGE stage;
+} pathological_sources[] = {
+	{ "operator chains",      STAGE_compiling },
+	{ "left nesting",         STAGE_compiling },
+	{ "right nesting",        STAGE_compiling },
+	{ "invalid utf-8",        STAGE_compiling },
+	{ "one row",              STAGE_compiling },
+	{ "unterminated string",  STAGE_lexing    },
+	{ "reference chains",     STAGE_compiling },
+};
+
+/* `*extent` is set to the chain's length or the nesting's depth, or 0 if the source has neither */
+static struct SOURCE generate_pathological_source(COUNT index, SIZE size, struct BUFFER *text, COUNT *extent) {
+	static const CHAR prefix[] = "v : int = ";
+	*extent = 0;
+	switch (index) {
+	case 0:
+		*extent = (size - sizeof(prefix)) / (sizeof(" + 1") - 1);
+		append_text(prefix, text);
+		append_text("1", text);
+		for (COUNT i = 0; i < *extent; ++i) append_text(" + 1", text);
+		append_text(";\n", text);
+		break;
+	case 1:
+		*extent = (size - sizeof(prefix)) / (sizeof("( + 1)") - 1);
+		append_text(prefix, text);
+		for (COUNT i = 0; i < *extent; ++i) append_text("(", text);
+		append_text("1", text);
+		for (COUNT i = 0; i < *extent; ++i) append_text(" + 1)", text);
+		append_text(";\n", text);
+		break;
+	case 2:
+		*extent = (size - sizeof(prefix)) / (sizeof("(1 + )") - 1);
+		append_text(prefix, text);
+		for (COUNT i = 0; i < *extent; ++i) append_text("(1 + ", text);
+		append_text("1", text);
+		for (COUNT i = 0; i < *extent; ++i) append_text(")", text);
+		append_text(";\n", text);
+		break;
+	case 3:
+		/* lone continuations, truncated sequences, overlongs, surrogates and codepoints past the last, in statements that declare nothing */
+		while (text->data_size < size) append_text("\"\x80\xbf\xc3\x28\xe2\x82\xf0\x90\x80\xc0\xaf\xed\xa0\x80\xf4\x90\x80\x80\xff\";\n", text);
+		break;
+	case 4:
+		while (text->data_size < size) append_text("a;", text);
+		break;
+	case 5:
+		append_text("v : int = \"", text);
+		while (text->data_size < size) append_text("a \\\" ", text);
+		break;
+	case 6:
+		/* the chain is the statement, and it has a reference for each level down to the deepest */
+		append_text("v : int = 1;\n", text);
+		while (text->data_size < size) {
+			append_text("v", text);
+			for (COUNT i = 1; i < MAXIMUM_TREE_DEPTH; ++i) append_text(" + v", text);
+			append_text(";\n", text);
+		}
+		break;
+	}
+	struct SOURCE source = { 0 };
+	copy(source.path, pathological_sources[index].name, get_size_of_string(pathological_sources[index].name));
+	source.size = text->data_size;
+	(VOID)push(sizeof(UTF32), 1, text);
+	source.data = text->data;
+	return source;
+}
+
+/* returns how many kinds of sources grew superlinearly */
+static COUNT check_growth(const HANDLE counters[2]) {
+	COUNT superlinear_count = 0;
+	for (COUNT i = 0; i < sizeof(pathological_sources) / sizeof(pathological_sources[0]); ++i) {
+		F64 smallest_seconds = 0, smallest_peak = 0, time_growth = 0, peak_growth = 0;
+		COUNT smallest_extent = 0, extent = 0;
+		for (SIZE size = SMALLEST_GROWTH_SIZE; size <= LARGEST_GROWTH_SIZE; size *= 2) {
+			struct BUFFER text = DEFAULT_BUFFER;
+			struct SOURCE source = generate_pathological_source(i, size, &text, &extent);
+			struct MEASUREMENT measurement = measure_front_end(&source, pathological_sources[i].stage, counters);
+			F64 seconds = 1.0 / measurement.bytes_per_second, peak = (F64)measurement.peak_size / source.size;
+			if (size == SMALLEST_GROWTH_SIZE) {
+				smallest_seconds = seconds;
+				smallest_peak = peak;
+				smallest_extent = extent;
+			}
+			time_growth = seconds / smallest_seconds;
+			peak_growth = peak / smallest_peak;
+			release_virtual_memory(text.data, text.reservation_size);
+		}
+		/* the chains and the nestings must've grown with the size, or it's only been checked that repeating them is linear */
+		assert(extent >= smallest_extent * (LARGEST_GROWTH_SIZE / SMALLEST_GROWTH_SIZE));
+		report(SEVERITY_comment, 0, 0, "%s: %.2fx the time and %.2fx the peak for each byte from %u to %u bytes", pathological_sources[i].name, time_growth, peak_growth, SMALLEST_GROWTH_SIZE, LARGEST_GROWTH_SIZE);
+		if (extent) report(SEVERITY_comment, 0, 0, "%s: from %u to %u operations in one statement", pathological_sources[i].name, smallest_extent, extent);
+		if (time_growth > MAXIMUM_TIME_GROWTH || peak_growth > MAXIMUM_PEAK_GROWTH) {
+			report(SEVERITY_caution, 0, 0, "%s grew superlinearly", pathological_sources[i].name);
+			++superlinear_count;
+		}
+	}
+	return superlinear_count;
+}
+
+/* the machine's baselines only have the time, and the shared ones have it only when there aren't any for the machine */
+static VOID write_baselines(const CHAR *path, const struct MEASUREMENT *measurements, COUNT measurements_count, BOOLEAN is_machine, BOOLEAN has_time) {
+	struct BUFFER text = DEFAULT_BUFFER;
+	for (COUNT i = 0; i < measurements_count; ++i) {
+		append_text(measurements[i].name, &text);
+		U64 fields[] = { measurements[i].bytes_per_second, measurements[i].instructions_count, measurements[i].cache_misses_count, measurements[i].peak_size };
+		for (COUNT j = 0; j < sizeof(fields) / sizeof(fields[0]); ++j) {
+			append_text(" ", &text);
+			if (fields[j] == UNMEASURED || (j ? is_machine : !has_time)) append_text("-", &text);
+			else append_natural(fields[j], &text);
+		}
+		append_text("\n", &text);
+	}
+	HANDLE file = create_file(path);
+	(VOID)write_to_file(text.data, text.data_size, file);
+	close_file(file);
+	release_virtual_memory(text.data, text.reservation_size);
+}
+
+static BOOLEAN find_baseline(const struct SOURCE *baselines, const CHAR *name, struct MEASUREMENT *baseline) {
+	for (const CHAR *line = baselines->data; line < baselines->data + baselines->size;)
+		if (parse_baseline(&line, baselines->data + baselines->size, baseline) && !compare_strings(baseline->name, name)) return 1;
+	return 0;
+}
+
+static VOID run_gate(const CHAR *const *paths, COUNT paths_count, const CHAR *baselines_path, const CHAR *machine_baselines_path, BOOLEAN is_recording, U64 threshold) {
+	HANDLE counters[2] = { open_event_counter(EVENT_instructions), open_event_counter(EVENT_cache_misses) };
+	if (counters[0] == -1) report(SEVERITY_caution, 0, 0, "instructions can't be counted, so time is gated on instead");
+	COUNT superlinear_count = check_growth(counters);
+
+	struct BUFFER measurements_buffer = DEFAULT_BUFFER;
+	COUNT generated_sources_count = sizeof(generated_source_names) / sizeof(generated_source_names[0]);
+	for (COUNT i = 0; i < generated_sources_count + paths_count; ++i) {
+		struct BUFFER text = DEFAULT_BUFFER;
+		struct SOURCE source = i < generated_sources_count ? generate_source(i, &text) : load_source(paths[i - generated_sources_count]);
+		if (!source.data) fail(0, 0, "can't open %s", source.path);
+		struct MEASUREMENT *measurement = push(sizeof(struct MEASUREMENT), alignof(struct MEASUREMENT), &measurements_buffer);
+		*measurement = measure_front_end(&source, STAGE_parsing, counters);
+		report(SEVERITY_comment, 0, 0, "%s: %.2f MB/s, %lld instructions, %lld cache misses, %llu bytes at peak", measurement->name, measurement->bytes_per_second / 1e6, measurement->instructions_count, measurement->cache_misses_count, measurement->peak_size);
+		if (text.data) release_virtual_memory(text.data, text.reservation_size);
+		else release_virtual_memory(source.data, source.size + sizeof(UTF32));
+	}
+	for (COUNT i = 0; i < 2; ++i)
+		if (counters[i] != -1) close_event_counter(counters[i]);
+	const struct MEASUREMENT *measurements = measurements_buffer.data;
+	COUNT measurements_count = measurements_buffer.data_size / sizeof(struct MEASUREMENT);
+
+	struct SOURCE machine_baselines = { 0 };
+	if (machine_baselines_path && !is_recording) machine_baselines = load_source(machine_baselines_path);
+	if (machine_baselines_path && !machine_baselines.data) {
+		write_baselines(machine_baselines_path, measurements, measurements_count, 1, 1);
+		if (!is_recording) {
+			report(SEVERITY_caution, 0, 0, "no time's been measured on this machine yet, so this run's is recorded in %s to gate the next ones on", machine_baselines_path);
+			machine_baselines = load_source(machine_baselines_path);
+			if (!machine_baselines.data) fail(0, 0, "can't open %s", machine_baselines_path);
+		}
+	}
+	if (is_recording) {
+		write_baselines(baselines_path, measurements, measurements_count, 0, !machine_baselines_path);
+		release_virtual_memory(measurements_buffer.data, measurements_buffer.reservation_size);
+		if (superlinear_count) fail(0, 0, "%u kinds of sources grew superlinearly", superlinear_count);
+		return;
+	}
+
+	struct SOURCE baselines = load_source(baselines_path);
+	if (!baselines.data) fail(0, 0, "can't open %s", baselines_path);
+	COUNT regressions_count = 0, missing_count = 0;
+	for (COUNT i = 0; i < measurements_count; ++i) {
+		const struct MEASUREMENT *measurement = &measurements[i];
+		struct MEASUREMENT baseline, machine_baseline;
+		BOOLEAN is_found = find_baseline(&baselines, measurement->name, &baseline);
+		if (!is_found || baseline.peak_size == UNMEASURED) {
+			report(SEVERITY_caution, 0, 0, is_found ? "there's no peak in the baseline for %s" : "there's no baseline for %s", measurement->name);
+			++missing_count;
+			continue;
+		}
+		if (machine_baselines.data) baseline.bytes_per_second = find_baseline(&machine_baselines, measurement->name, &machine_baseline) ? machine_baseline.bytes_per_second : UNMEASURED;
+		if (measurement->instructions_count != UNMEASURED && baseline.instructions_count != UNMEASURED)
+			regressions_count += compare_measurement(measurement->name, "instructions", measurement->instructions_count, baseline.instructions_count, 0, threshold);
+		else if (baseline.bytes_per_second != UNMEASURED)
+			regressions_count += compare_measurement(measurement->name, "bytes per second", measurement->bytes_per_second, baseline.bytes_per_second, 1, threshold);
+		else {
+			report(SEVERITY_caution, 0, 0, "there's no time on this machine in the baselines for %s, and its instructions can't be compared", measurement->name);
+			++missing_count;
+		}
+		regressions_count += compare_measurement(measurement->name, "bytes at peak", measurement->peak_size, baseline.peak_size, 0, threshold);
+	}
+	release_virtual_memory(baselines.data, baselines.size + sizeof(UTF32));
+	if (machine_baselines.data) release_virtual_memory(machine_baselines.data, machine_baselines.size + sizeof(UTF32));
+	release_virtual_memory(measurements_buffer.data, measurements_buffer.reservation_size);
+	if (superlinear_count) fail(0, 0, "%u kinds of sources grew superlinearly", superlinear_count);
+	if (missing_count) fail(0, 0, "%u sources have no baseline", missing_count);
+	if (regressions_count) fail(0, 0, "%u measurements regressed by more than %llu%%", regressions_count, threshold);
+	report(SEVERITY_comment, 0, 0, "nothing regressed by more than %llu%%", threshold);
+}
+
+struct BENCHMARK {
+	CHAR name[16];
+	VOID (*procedure)(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count);
+};
+
+static const struct BENCHMARK benchmarks[] = {
+	{ "ranges",      benchmark_range_index },
+	{ "interner",    benchmark_interner    },
+	{ "structure",   benchmark_structure   },
+	{ "syntax",      benchmark_syntax      },
+	{ "tokens",      benchmark_tokens      },
+	{ "formatter",   benchmark_formatter   },
+	{ "checker",     benchmark_checker     },
+	{ "interpreter", benchmark_interpreter },
+};
+
+/*
+NOTE(Emhyr): a directory's sources are found by walking it, and they're
+compiled as they're found instead of after the whole walk. a few threads take
+directories from a queue, list them, and queue the subdirectories that they
+find, so the walk is as wide as the tree is. the files with the extension are
+published in the order that they're found, which changes from run to run.
+names that begin with a full stop are hidden, so they're skipped.
+
+listing a big tree is what's slow, so the walk can be saved as a listing and
+reused. a directory that was modified when it was saved isn't listed again,
+since adding, removing or renaming what's in it changes when it was modified.
+what's in its subdirectories doesn't, so they're each checked the same way.
+a time is only as fine as the file system's clock, so a directory that's
+changed within a tick of being listed may be missed until it's changed again.
+
+a listing has a line for each directory, with its modification time and path,
+followed by a line for each of its entries that's indented by a tab. every
+regular file's saved, so that a listing's reused whatever the extension is; a
+subdirectory's name ends with a slash.
+*/
+
+#define WALKING_THREADS_COUNT 8
+
+struct LISTING {
+	struct SOURCE text;
+	COUNT *slots; /* of the directories' lines' offsets, plus 1; 0 if it's empty */
+	COUNT slots_count;
+};
+
+struct FINDER {
+	const CHAR *extension;
+	const struct LISTING *listing;
+	struct BUFFER paths; /* that are found */
+	struct BUFFER directories; /* of the paths that are queued */
+	struct BUFFER files; /* of the paths */
+	COUNT directories_count;
+	COUNT next_directory; /* that no thread is walking yet */
+	COUNT pending_count; /* of the directories that are queued or walked */
+	COUNT files_count;
+	BOOLEAN is_finished;
+	BYTE lock; /* of the paths, the directories and the files */
+	HANDLE threads[WALKING_THREADS_COUNT];
+	struct BUFFER records[WALKING_THREADS_COUNT]; /* of what each thread saves to the listing */
+	COUNT next_thread;
+};
+
+static VOID lock_finder(struct FINDER *finder) {
+	while (__atomic_test_and_set(&finder->lock, __ATOMIC_ACQUIRE)) yield_thread();
+}
+
+static VOID unlock_finder(struct FINDER *finder) {
+	__atomic_clear(&finder->lock, __ATOMIC_RELEASE);
+}
+
+static VOID queue_path(const CHAR *path, SIZE size, BOOLEAN is_directory, struct FINDER *finder) {
+	lock_finder(finder);
+	CHAR *copied_path = push(size + 1, 1, &finder->paths);
+	copy(copied_path, path, size);
+	if (is_directory) {
+		*(const CHAR **)push(sizeof(CHAR *), alignof(CHAR *), &finder->directories) = copied_path;
+		++finder->directories_count;
+		__atomic_add_fetch(&finder->pending_count, 1, __ATOMIC_RELAXED);
+	} else {
+		*(const CHAR **)push(sizeof(CHAR *), alignof(CHAR *), &finder->files) = copied_path;
+		__atomic_store_n(&finder->files_count, finder->files_count + 1, __ATOMIC_RELEASE);
+	}
+	unlock_finder(finder);
+}
+
+static VOID load_listing(const CHAR *path, struct LISTING *listing) {
+	*listing = (struct LISTING){ .text = load_source(path) };
+	if (!listing->text.data) return;
+	const CHAR *text = listing->text.data, *ending = text + listing->text.size;
+	COUNT directories_count = 0;
+	for (const CHAR *line = text; line < ending; ++line) {
+		directories_count += *line != '\t';
+		while (line < ending && *line != '\n') ++line;
+	}
+	listing->slots_count = 1;
+	while (listing->slots_count < directories_count * 2) listing->slots_count *= 2;
+	listing->slots = allocate_virtual_memory(listing->slots_count * sizeof(COUNT));
+	for (const CHAR *line = text; line < ending; ++line) {
+		const CHAR *line_beginning = line, *path_beginning;
+		while (line < ending && *line != '\n') ++line;
+		if (*line_beginning == '\t') continue;
+		for (path_beginning = line_beginning; path_beginning < line && *path_beginning != ' '; ++path_beginning);
+		if (path_beginning++ == line) continue;
+		COUNT i = hash_bytes(path_beginning, line - path_beginning) & (listing->slots_count - 1);
+		while (listing->slots[i]) i = (i + 1) & (listing->slots_count - 1);
+		listing->slots[i] = line_beginning - text + 1;
+	}
+}
+
+static VOID unload_listing(struct LISTING *listing) {
+	if (listing->slots) release_virtual_memory(listing->slots, listing->slots_count * sizeof(COUNT));
+	if (listing->text.data) release_virtual_memory(listing->text.data, listing->text.size + sizeof(UTF32));
+	*listing = (struct LISTING){ 0 };
+}
+
+/* returns the directory's first entry's line, or 0 if it wasn't saved as it was modified then */
+static const CHAR *find_listed_directory(const CHAR *path, U64 modification_time, const struct LISTING *listing) {
+	if (!listing || !listing->slots) return 0;
+	const CHAR *text = listing->text.data, *ending = text + listing->text.size;
+	SIZE size = get_size_of_string(path);
+	for (COUNT i = hash_bytes(path, size) & (listing->slots_count - 1); listing->slots[i]; i = (i + 1) & (listing->slots_count - 1)) {
+		const CHAR *line = text + listing->slots[i] - 1;
+		U64 listed_time = 0;
+		for (; *line >= '0' && *line <= '9'; ++line) listed_time = listed_time * 10 + (*line - '0');
+		++line;
+		if ((SIZE)(ending - line) <= size || line[size] != '\n' || __builtin_memcmp(line, path, size)) continue;
+		return listed_time == modification_time ? line + size + 1 : 0;
+	}
+	return 0;
+}
+
+struct WALK {
+	struct FINDER *finder;
+	struct BUFFER *records;
+	CHAR path[MAXIMUM_PATH_SIZE + 1]; /* of the directory that's walked */
+	SIZE path_size;
+};
+
+static VOID visit_entry(const CHAR *name, enum FILE_KIND kind, VOID *parameter) {
+	struct WALK *walk = parameter;
+	if (name[0] == '.' || (kind != FILE_KIND_directory && kind != FILE_KIND_regular)) return;
+	append_text("\t", walk->records);
+	append_text(name, walk->records);
+	append_text(kind == FILE_KIND_directory ? "/\n" : "\n", walk->records);
+
+	SIZE name_size = get_size_of_string(name);
+	if (walk->path_size + 1 + name_size > MAXIMUM_PATH_SIZE) {
+		report(SEVERITY_caution, 0, 0, "the path is too long: %s/%s", walk->path, name);
+		return;
+	}
+	if (kind == FILE_KIND_regular) {
+		const CHAR *extension = walk->finder->extension;
+		SIZE extension_size = get_size_of_string(extension);
+		if (name_size <= extension_size + 1 || name[name_size - extension_size - 1] != '.' || compare_strings(name + name_size - extension_size, extension)) return;
+	}
+	walk->path[walk->path_size] = '/';
+	copy(walk->path + walk->path_size + 1, name, name_size + 1);
+	queue_path(walk->path, walk->path_size + 1 + name_size, kind == FILE_KIND_directory, walk->finder);
+	walk->path[walk->path_size] = 0;
+}
+
+static VOID walk_directory(const CHAR *path, struct BUFFER *records, struct FINDER *finder) {
+	struct WALK walk = { .finder = finder, .records = records, .path_size = get_size_of_string(path) };
+	copy(walk.path, path, walk.path_size + 1);
+	U64 modification_time;
+	if (query_file(path, &modification_time) != FILE_KIND_directory) {
+		report(SEVERITY_caution, 0, 0, "can't list %s", path);
+		return;
+	}
+	SIZE records_size = records->data_size;
+	append_natural(modification_time, records);
+	append_text(" ", records);
+	append_text(path, records);
+	append_text("\n", records);
+
+	const CHAR *line = find_listed_directory(path, modification_time, finder->listing);
+	if (line) {
+		const CHAR *ending = finder->listing->text.data + finder->listing->text.size;
+		for (CHAR name[MAXIMUM_PATH_SIZE + 1]; line < ending && *line == '\t';) {
+			const CHAR *name_beginning = ++line;
+			while (line < ending && *line != '\n') ++line;
+			SIZE name_size = line++ - name_beginning;
+			BOOLEAN is_directory = name_size && name_beginning[name_size - 1] == '/';
+			name_size -= is_directory;
+			if (!name_size || name_size > MAXIMUM_PATH_SIZE) continue;
+			copy(name, name_beginning, name_size);
+			name[name_size] = 0;
+			visit_entry(name, is_directory ? FILE_KIND_directory : FILE_KIND_regular, &walk);
+		}
+	} else if (!list_directory(path, visit_entry, &walk)) {
+		records->data_size = records_size;
+		report(SEVERITY_caution, 0, 0, "can't list %s", path);
+	}
+}
+
+static WORD walk_directories(VOID *parameter) {
+	struct FINDER *finder = parameter;
+	struct BUFFER *records = &finder->records[__atomic_fetch_add(&finder->next_thread, 1, __ATOMIC_RELAXED)];
+	for (;;) {
+		lock_finder(finder);
+		const CHAR *path = finder->next_directory < finder->directories_count ? ((const CHAR **)finder->directories.data)[finder->next_directory++] : 0;
+		unlock_finder(finder);
+		if (!path) {
+			if (!__atomic_load_n(&finder->pending_count, __ATOMIC_ACQUIRE)) break;
+			yield_thread();
+			continue;
+		}
+		walk_directory(path, records, finder);
+		if (!__atomic_sub_fetch(&finder->pending_count, 1, __ATOMIC_ACQ_REL)) __atomic_store_n(&finder->is_finished, 1, __ATOMIC_RELEASE);
+	}
+	return 0;
+}
+
+/* the listing's the caller's, and it may be 0 */
+static VOID begin_walking(const CHAR *path, const CHAR *extension, const struct LISTING *listing, struct FINDER *finder) {
+	*finder = (struct FINDER){ .extension = extension, .listing = listing };
+	SIZE size = get_size_of_string(path);
+	while (size > 1 && path[size - 1] == '/') --size;
+	queue_path(path, size, 1, finder);
+	for (COUNT i = 0; i < WALKING_THREADS_COUNT; ++i)
+		finder->threads[i] = create_thread(walk_directories, finder);
+}
+
+/* returns 0 if the walk's finished without finding a file for the index */
+static const CHAR *wait_for_found_file(COUNT index, struct FINDER *finder) {
+	for (;;) {
+		BOOLEAN is_finished = __atomic_load_n(&finder->is_finished, __ATOMIC_ACQUIRE);
+		if (index < __atomic_load_n(&finder->files_count, __ATOMIC_ACQUIRE)) return ((const CHAR **)finder->files.data)[index];
+		if (is_finished) return 0;
+		yield_thread();
+	}
+}
+
+/* saves the walk as a listing if there's a path for it */
+static VOID end_walking(const CHAR *listing_path, struct FINDER *finder) {
+	for (COUNT i = 0; i < WALKING_THREADS_COUNT; ++i)
+		join_thread(finder->threads[i]);
+	if (listing_path) {
+		HANDLE file = create_file(listing_path);
+		for (COUNT i = 0; i < WALKING_THREADS_COUNT; ++i)
+			if (finder->records[i].data_size) (VOID)write_to_file(finder->records[i].data, finder->records[i].data_size, file);
+		close_file(file);
+	}
+	struct BUFFER *buffers[] = { &finder->paths, &finder->directories, &finder->files };
+	for (COUNT i = 0; i < sizeof(buffers) / sizeof(buffers[0]); ++i)
+		if (buffers[i]->data) release_virtual_memory(buffers[i]->data, buffers[i]->reservation_size);
+	for (COUNT i = 0; i < WALKING_THREADS_COUNT; ++i)
+		if (finder->records[i].data) release_virtual_memory(finder->records[i].data, finder->records[i].reservation_size);
+	*finder = (struct FINDER){ 0 };
+}
+
+#define MAXIMUM_PATHS_COUNT 1024
+#define DEFAULT_EXTENSION   "txt"
+
+struct OPTIONS {
+	const CHAR *paths[MAXIMUM_PATHS_COUNT];
+	COUNT paths_count;
+	const CHAR *object_path;
+	const struct BENCHMARK *benchmark;
+	BOOLEAN is_hash_consing;
+	BOOLEAN is_evaluating;
+	BOOLEAN is_jitting;
+	BOOLEAN is_optimizing;
+	BOOLEAN is_serving;
+	BOOLEAN is_streaming;
+	BOOLEAN is_fingerprinting;
+	BOOLEAN is_validating;
+	BOOLEAN is_reporting_memory;
+	BOOLEAN is_formatting;
+	BOOLEAN is_walking; /* if a path is a directory */
+	const CHAR *extension; /* of the sources in the directories */
+	const CHAR *listing_path; /* if the directories' listing is saved and reused */
+	const CHAR *baselines_path; /* if the front end is gated */
+	const CHAR *machine_baselines_path; /* of the time on this machine, which the first gate to run on it records */
+	BOOLEAN is_recording_baselines;
+	U64 threshold; /* percent */
+};
+
+static VOID parse_options(int argc, char *argv[], struct OPTIONS *options) {
+	*options = (struct OPTIONS){ .extension = DEFAULT_EXTENSION, .threshold = DEFAULT_THRESHOLD };
+	for (int i = 1; i < argc; ++i) {
+		if (!compare_strings(argv[i], "--hash-cons")) options->is_hash_consing = 1;
+		else if (!compare_strings(argv[i], "--evaluate")) options->is_evaluating = 1;
+		else if (!compare_strings(argv[i], "--jit")) options->is_jitting = 1;
+		else if (!compare_strings(argv[i], "--ir")) options->is_optimizing = 1;
+		else if (!compare_strings(argv[i], "--serve")) options->is_serving = 1;
+		else if (!compare_strings(argv[i], "--stream")) options->is_streaming = 1;
+		else if (!compare_strings(argv[i], "--fingerprint")) options->is_fingerprinting = 1;
+		else if (!compare_strings(argv[i], "--check-syntax")) options->is_validating = 1;
+		else if (!compare_strings(argv[i], "--stats")) options->is_reporting_memory = 1;
+		else if (!compare_strings(argv[i], "--format")) options->is_formatting = 1;
+		else if (!compare_strings(argv[i], "-o")) {
+			if (++i == argc) fail(0, 0, "a path for the object must be given");
+			options->object_path = argv[i];
+		}
+		else if (!compare_strings(argv[i], "--extension")) {
+			if (++i == argc) fail(0, 0, "an extension must be given");
+			options->extension = argv[i][0] == '.' ? argv[i] + 1 : argv[i];
+		}
+		else if (!compare_strings(argv[i], "--listing")) {
+			if (++i == argc) fail(0, 0, "a path for the listing must be given");
+			options->listing_path = argv[i];
+		}
+		else if (!compare_strings(argv[i], "--gate") || !compare_strings(argv[i], "--baseline")) {
+			options->is_recording_baselines = !compare_strings(argv[i], "--baseline");
+			if (++i == argc) fail(0, 0, "a path for the baselines must be given");
+			options->baselines_path = argv[i];
+		}
+		else if (!compare_strings(argv[i], "--machine-baselines")) {
+			if (++i == argc) fail(0, 0, "a path for the machine's baselines must be given");
+			options->machine_baselines_path = argv[i];
+		}
+		else if (!compare_strings(argv[i], "--threshold")) {
+			if (++i == argc) fail(0, 0, "a threshold must be given");
+			options->threshold = 0;
+			for (const CHAR *digit = argv[i]; *digit; ++digit) {
+				if (*digit < '0' || *digit > '9') fail(0, 0, "the threshold must be a natural number of percent: %s", argv[i]);
+				options->threshold = options->threshold * 10 + (*digit - '0');
+			}
+		}
+		else if (!compare_strings(argv[i], "--benchmark")) {
+			if (++i == argc) fail(0, 0, "a benchmark must be given");
+			for (COUNT j = 0; j < sizeof(benchmarks) / sizeof(benchmarks[0]); ++j)
+				if (!compare_strings(argv[i], benchmarks[j].name)) options->benchmark = &benchmarks[j];
+			if (!options->benchmark) fail(0, 0, "unknown benchmark: %s", argv[i]);
+		} else if (argv[i][0] == '-' && argv[i][1] == '-') fail(0, 0, "unknown option: %s", argv[i]);
+		else {
+			if (options->paths_count == MAXIMUM_PATHS_COUNT) fail(0, 0, "there can't be more than %u paths", MAXIMUM_PATHS_COUNT);
+			if (get_size_of_string(argv[i]) > MAXIMUM_PATH_SIZE) fail(0, 0, "the path is too long: %s", argv[i]);
+			options->paths[options->paths_count++] = argv[i];
+			U64 modification_time;
+			if (query_file(argv[i], &modification_time) == FILE_KIND_directory) options->is_walking = 1;
+		}
+	}
+	if (!options->paths_count && !options->is_serving && !options->baselines_path) fail(0, 0, "a path must be given");
+	if ((options->paths_count > 1 || options->is_walking) && options->object_path) fail(0, 0, "an object is written for one source only");
+	if (options->is_streaming && (options->benchmark || options->is_hash_consing || options->is_evaluating || options->is_jitting || options->is_optimizing || options->object_path))
+		fail(0, 0, "a stream is only parsed, since it isn't kept");
+	if (options->is_validating && (options->benchmark || options->is_hash_consing || options->is_evaluating || options->is_jitting || options->is_optimizing || options->object_path || options->is_fingerprinting))
+		fail(0, 0, "a source is only validated when its syntax is checked");
+	if (options->baselines_path && (options->benchmark || options->is_hash_consing || options->is_evaluating || options->is_jitting || options->is_optimizing || options->object_path || options->is_fingerprinting || options->is_serving || options->is_streaming || options->is_validating))
+		fail(0, 0, "a gated source is only parsed");
+	if (options->is_formatting && (options->benchmark || options->is_hash_consing || options->is_evaluating || options->is_jitting || options->is_optimizing || options->object_path || options->is_fingerprinting || options->is_serving || options->is_streaming || options->is_validating || options->baselines_path || options->is_reporting_memory))
+		fail(0, 0, "a formatted source is only lexed");
+	if (options->is_walking && (options->is_streaming || options->baselines_path)) fail(0, 0, "a directory can't be streamed or gated");
+	if (options->machine_baselines_path && !options->baselines_path) fail(0, 0, "the machine's baselines are only for the gate");
+}
+
+/*
+NOTE(Emhyr): a session is what outlives a compilation. a one-off compilation
+only has the one, but a server keeps it warm between requests: the arenas are
+reset rather than released, the interner is never reset (so a name keeps its
+symbol), and sources are cached with their pristine parses, which are copied
+out on every request because the analysis rewrites nodes in place. checking
+a source's syntax goes through the cache too, since a cached source is already
+known to parse, and a changed one is parsed for the requests that follow.
+*/
+
+struct CACHED_SOURCE {
+	struct SOURCE source;
+	struct BUFFER statements;
+	struct BUFFER nodes;
+	COUNT statements_count;
+	BOOLEAN is_parsed; /* it isn't while it's parsed, in case that fails */
+};
+
+struct SESSION {
+	struct BUFFER buffer; /* whatever's pushed while compiling */
+	struct INTERNER interner;
+	struct DAG dag;
+	struct TYPES types;
+	struct DECLARATIONS declarations;
+	struct BUFFER instructions;
+	struct WORKER parser;
+	struct LOADER loader;
+	struct STREAM stream;
+	struct BUFFER input;
+	struct BUFFER cached_sources;
+	COUNT cached_sources_count;
+	struct BUFFER checkers; /* of each checker's buffer, which is kept between sources */
+	COUNT checkers_count;
+};
+
+/* a session must stay where it is, because its parts point to its interner */
+static VOID begin_session(struct SESSION *session) {
+	*session = (struct SESSION){ 0 };
+	session->dag.interner = &session->interner;
+	session->types.lengths.interner = &session->interner;
+	session->types.interner = &session->interner;
+	session->declarations.interner = &session->interner;
+}
+
+static VOID reset_dag(struct DAG *dag) {
+	dag->nodes.data_size = 0;
+	dag->nodes_count = 0;
+	dag->uses_count = 0;
+	if (dag->slots) fill(dag->slots, 0, dag->slots_count * sizeof(COUNT));
+}
+
+/* the entries that are never used are pushed along with the first slots, so they're kept */
+static VOID reset_session(struct SESSION *session) {
+	session->buffer.data_size = 0;
+	reset_dag(&session->dag);
+
+	struct TYPES *types = &session->types;
+	types->types.data_size = types->slots ? sizeof(struct INTERNED_TYPE) : 0;
+	types->operands.data_size = 0;
+	types->types_count = 0;
+	if (types->slots) fill(types->slots, 0, types->slots_count * sizeof(TYPE));
+	reset_dag(&types->lengths);
+
+	struct DECLARATIONS *declarations = &session->declarations;
+	declarations->declarations.data_size = declarations->slots ? sizeof(struct DECLARATION) : 0;
+	declarations->declarations_count = 0;
+	declarations->scopes.data_size = 0;
+	declarations->scopes_count = 0;
+	declarations->scope_from_type.data_size = 0;
+	if (declarations->slots) fill(declarations->slots, 0, declarations->slots_count * sizeof(COUNT));
+
+	session->instructions.data_size = 0;
+	session->parser.buffer.data_size = 0;
+	for (COUNT i = 0; i < session->checkers_count; ++i)
+		((struct BUFFER *)session->checkers.data)[i].data_size = 0;
+}
+
+#define SESSION_WATERMARK MEBIBYTES(1)
+
+struct ARENA {
+	const CHAR *name;
+	struct BUFFER *buffer;
+};
+
+#define SESSION_ARENAS_COUNT 16
+
+static VOID get_session_arenas(struct SESSION *session, struct ARENA arenas[SESSION_ARENAS_COUNT]) {
+	COUNT i = 0;
+	arenas[i++] = (struct ARENA){ "compilation",        &session->buffer };
+	arenas[i++] = (struct ARENA){ "texts",              &session->interner.texts };
+	arenas[i++] = (struct ARENA){ "symbols",            &session->interner.symbols };
+	arenas[i++] = (struct ARENA){ "dag",                &session->dag.nodes };
+	arenas[i++] = (struct ARENA){ "types",              &session->types.types };
+	arenas[i++] = (struct ARENA){ "operands",           &session->types.operands };
+	arenas[i++] = (struct ARENA){ "lengths",            &session->types.lengths.nodes };
+	arenas[i++] = (struct ARENA){ "declarations",       &session->declarations.declarations };
+	arenas[i++] = (struct ARENA){ "scopes",             &session->declarations.scopes };
+	arenas[i++] = (struct ARENA){ "scopes from types",  &session->declarations.scope_from_type };
+	arenas[i++] = (struct ARENA){ "instructions",       &session->instructions };
+	arenas[i++] = (struct ARENA){ "parser",             &session->parser.buffer };
+	arenas[i++] = (struct ARENA){ "input",              &session->input };
+	arenas[i++] = (struct ARENA){ "cached sources",     &session->cached_sources };
+	arenas[i++] = (struct ARENA){ "checkers' buffers",  &session->checkers };
+	arenas[i++] = (struct ARENA){ "stream",             &session->stream.reservation };
+	assert(i == SESSION_ARENAS_COUNT);
+}
+
+/* what an idle session keeps committed in each arena */
+static VOID trim_session(struct SESSION *session) {
+	struct ARENA arenas[SESSION_ARENAS_COUNT];
+	get_session_arenas(session, arenas);
+	for (COUNT i = 0; i < SESSION_ARENAS_COUNT; ++i)
+		trim_buffer(SESSION_WATERMARK, arenas[i].buffer);
+	for (COUNT i = 0; i < session->checkers_count; ++i)
+		trim_buffer(SESSION_WATERMARK, (struct BUFFER *)session->checkers.data + i);
+
+	/* a cached parse only grows when its source changes, so nothing's kept past it */
+	for (COUNT i = 0; i < session->cached_sources_count; ++i) {
+		struct CACHED_SOURCE *cached = (struct CACHED_SOURCE *)session->cached_sources.data + i;
+		trim_buffer(0, &cached->statements);
+		trim_buffer(0, &cached->nodes);
+	}
+}
+
+static VOID report_arena(const CHAR *name, const struct BUFFER *buffer) {
+	report(SEVERITY_comment, 0, 0, "%-18s %10llu used %10llu peak %10llu committed", name, buffer->data_size, buffer->peak_size, buffer->data ? buffer->commission_size : 0);
+}
+
+static VOID add_arena(const struct BUFFER *buffer, struct BUFFER *total) {
+	if (!buffer->data) return;
+	total->data = buffer->data;
+	total->data_size += buffer->data_size;
+	total->peak_size += buffer->peak_size;
+	total->commission_size += buffer->commission_size;
+}
+
+/* the parsers are the workers whose buffers have the statements' nodes, if they're still around */
+static VOID report_memory(const CHAR *subject, struct SESSION *session, const struct WORKER *parsers, COUNT parsers_count) {
+	struct ARENA arenas[SESSION_ARENAS_COUNT];
+	get_session_arenas(session, arenas);
+	report(SEVERITY_comment, 0, 0, "memory after %s:", subject);
+	struct BUFFER total = { 0 };
+	for (COUNT i = 0; i < SESSION_ARENAS_COUNT; ++i) {
+		if (!arenas[i].buffer->data) continue;
+		report_arena(arenas[i].name, arenas[i].buffer);
+		add_arena(arenas[i].buffer, &total);
+	}
+
+	/* the arenas there's one of for each worker or cached source are reported together */
+	struct BUFFER totals[4] = { 0 };
+	static const CHAR names[4][18] = { "parsers", "diagnostics", "cached statements", "cached nodes" };
+	for (COUNT i = 0; i < parsers_count; ++i) add_arena(&parsers[i].buffer, &totals[0]);
+	for (COUNT i = 0; i < session->checkers_count; ++i) add_arena((struct BUFFER *)session->checkers.data + i, &totals[1]);
+	for (COUNT i = 0; i < session->cached_sources_count; ++i) {
+		const struct CACHED_SOURCE *cached = (struct CACHED_SOURCE *)session->cached_sources.data + i;
+		add_arena(&cached->statements, &totals[2]);
+		add_arena(&cached->nodes, &totals[3]);
+	}
+	for (COUNT i = 0; i < 4; ++i) {
+		if (!totals[i].data) continue;
+		report_arena(names[i], &totals[i]);
+		add_arena(&totals[i], &total);
+	}
+	report_arena("total", &total);
+}
+
+/* the statements are pushed, then their nodes */
+static struct STATEMENT *copy_statements(const struct STATEMENT *statements, COUNT statements_count, const VOID *nodes, SIZE nodes_size, C_BUFFER *statements_buffer, C_BUFFER *nodes_buffer) {
+	struct STATEMENT *result = push(statements_count * sizeof(struct STATEMENT), alignof(struct STATEMENT), statements_buffer);
+	BYTE *result_nodes = push(nodes_size, alignof(struct NODE), nodes_buffer);
+	copy(result, statements, statements_count * sizeof(struct STATEMENT));
+	copy(result_nodes, nodes, nodes_size);
+	for (COUNT i = 0; i < statements_count; ++i)
+		result[i].nodes = (struct NODE *)(result_nodes + ((const BYTE *)statements[i].nodes - (const BYTE *)nodes));
+	return result;
+}
+
+/* a source is reparsed only if its contents changed */
+static struct STATEMENT *parse_cached_source(struct SOURCE loaded_source, const struct SOURCE **source, COUNT *statements_count, struct SESSION *session) {
+	const CHAR *path = loaded_source.path;
+
+	struct CACHED_SOURCE *cached = 0;
+	for (COUNT i = 0; i < session->cached_sources_count && !cached; ++i)
+		if (!compare_strings(((struct CACHED_SOURCE *)session->cached_sources.data)[i].source.path, path)) cached = (struct CACHED_SOURCE *)session->cached_sources.data + i;
+	if (!cached) {
+		cached = push(sizeof(struct CACHED_SOURCE), alignof(struct CACHED_SOURCE), &session->cached_sources);
+		++session->cached_sources_count;
+	}
+
+	if (cached->is_parsed && cached->source.size == loaded_source.size && !__builtin_memcmp(cached->source.data, loaded_source.data, loaded_source.size)) {
+		release_virtual_memory(loaded_source.data, loaded_source.size + sizeof(UTF32));
+	} else {
+		if (cached->source.data) release_virtual_memory(cached->source.data, cached->source.size + sizeof(UTF32));
+		cached->source = loaded_source;
+		cached->is_parsed = 0;
+		cached->statements.data_size = 0;
+		cached->nodes.data_size = 0;
+
+		cached->statements_count = scan_statements(&cached->source, &session->buffer);
+		struct STATEMENT *statements = session->buffer.data;
+		COUNT next_statement = 0;
+		session->parser.source = &cached->source;
+		session->parser.statements = statements;
+		session->parser.statements_count = cached->statements_count;
+		session->parser.next_statement = &next_statement;
+		(VOID)parse_statements(&session->parser);
+		(VOID)copy_statements(statements, cached->statements_count, session->parser.buffer.data, session->parser.buffer.data_size, &cached->statements, &cached->nodes);
+		session->buffer.data_size = 0;
+		session->parser.buffer.data_size = 0;
+		cached->is_parsed = 1;
+	}
+
+	*source = &cached->source;
+	*statements_count = cached->statements_count;
+	return copy_statements(cached->statements.data, cached->statements_count, cached->nodes.data, cached->nodes.data_size, &session->buffer, &session->buffer);
+}
+
+static VOID compile_source(const struct SOURCE *source, struct STATEMENT *statements, COUNT statements_count, const struct OPTIONS *options, struct SESSION *session) {
+	if (options->benchmark) {
+		options->benchmark->procedure(source, statements, statements_count);
+		return;
+	}
+
+	U64 fingerprint = 0;
+	if (options->is_fingerprinting || options->object_path) fingerprint = fingerprint_statements(0, source, statements, statements_count);
+	if (options->is_fingerprinting) report(SEVERITY_comment, 0, 0, "fingerprint of %s: %016llx", source->path, fingerprint);
+
+	struct DAG *dag = &session->dag;
+	struct DECLARATIONS *declarations = &session->declarations;
+	analyze_statements(source, statements, statements_count, &session->types, declarations);
+	COUNT checkers_count = query_processor_count();
+	if (!checkers_count) checkers_count = 1;
+	for (; session->checkers_count < checkers_count; ++session->checkers_count)
+		*(struct BUFFER *)push(sizeof(struct BUFFER), alignof(struct BUFFER), &session->checkers) = DEFAULT_BUFFER;
+	(VOID)check_statements(statements, statements_count, declarations, checkers_count, session->checkers.data, &session->buffer);
+	BOOLEAN is_compiling = options->is_evaluating || options->is_jitting || options->is_optimizing || options->object_path;
+	for (COUNT i = 0; i < statements_count; ++i) {
+		if (options->is_hash_consing && statements[i].nodes_count) statements[i].dag_node = share_subtree(statements[i].nodes, source, dag);
+		if (!is_compiling) dump(source, statements[i].nodes, statements[i].nodes_count);
+		for (COUNT j = 0; j < statements[i].diagnostics_count; ++j)
+			report(SEVERITY_caution, source, &statements[i].diagnostics[j].node->range, "%s", string_from_check[statements[i].diagnostics[j].check]);
+		if (!is_compiling) puts("--------------------------\n");
+	}
+
+	struct BYTECODE bytecode = { .instructions = session->instructions };
+	if (is_compiling) compile_statements(statements, statements_count, declarations, &bytecode);
+	if (options->object_path) {
+		struct MACHINE_CODE code = { .text = DEFAULT_BUFFER };
+		for (COUNT i = 0; i < statements_count; ++i)
+			if (bytecode.chunks[i].offset == NO_CHUNK) report(SEVERITY_caution, source, &bytecode.chunks[i].unsupported->range, "can't be compiled");
+		generate_machine_code(&bytecode, statements_count, 0, &code);
+		write_object(options->object_path, &code, declarations);
+		write_fingerprint(options->object_path, fingerprint);
+		release_machine_code(&code);
+	}
+	if (options->is_evaluating) {
+		SIZE globals_size = (declarations->declarations_count + 1) * sizeof(union VALUE);
+		union VALUE *globals = allocate_virtual_memory(globals_size);
+		union VALUE registers[MAXIMUM_REGISTERS_COUNT], result;
+		SIZE instructions_count = 0;
+		for (COUNT i = 0; i < statements_count; ++i) {
+			const struct CHUNK *chunk = &bytecode.chunks[i];
+			if (chunk->offset == NO_CHUNK)
+				report(SEVERITY_caution, source, &chunk->unsupported->range, "can't be evaluated");
+			else if (!interpret((INSTRUCTION *)bytecode.instructions.data + chunk->offset, registers, globals, &result, &instructions_count))
+				report(SEVERITY_caution, source, &statements[i].nodes->range, "division by zero");
+			else if (chunk->kind == KIND_real)
+				report(SEVERITY_comment, source, &statements[i].nodes->range, "%g", result.real);
+			else
+				report(SEVERITY_comment, source, &statements[i].nodes->range, "%llu", result.natural);
+		}
+		release_virtual_memory(globals, globals_size);
+	}
+	if (options->is_jitting) {
+		struct MACHINE_CODE code = { .text = DEFAULT_BUFFER };
+		COUNT *entries = push(statements_count * sizeof(COUNT), alignof(COUNT), &session->buffer);
+		generate_machine_code(&bytecode, statements_count, entries, &code);
+		struct JIT jit;
+		load_machine_code(&code, declarations->declarations_count, &jit);
+		release_machine_code(&code);
+		union VALUE result;
+		for (COUNT i = 0; i < statements_count; ++i) {
+			if (entries[i] == NO_CHUNK)
+				report(SEVERITY_caution, source, &bytecode.chunks[i].unsupported->range, "can't be evaluated");
+			else if (!run_machine_code(entries[i], &jit, &result))
+				report(SEVERITY_caution, source, &statements[i].nodes->range, "division by zero");
+			else if (bytecode.chunks[i].kind == KIND_real)
+				report(SEVERITY_comment, source, &statements[i].nodes->range, "%g", result.real);
+			else
+				report(SEVERITY_comment, source, &statements[i].nodes->range, "%llu", result.natural);
+		}
+		unload_machine_code(&jit);
+	}
+	if (options->is_optimizing) {
+		struct IR ir = { .instructions = DEFAULT_BUFFER };
+		build_ir(statements, statements_count, &bytecode, &ir);
+		optimize_ir(&ir);
+		dump_ir(&ir);
+		release_ir(&ir);
+	}
+	if (options->is_hash_consing)
+		report(SEVERITY_comment, 0, 0, "hash-consed %llu nodes into %u", dag->uses_count, dag->nodes_count);
+
+	if (is_compiling) release_bytecode(statements_count, &bytecode);
+	session->instructions = bytecode.instructions;
+}
+
+/*
+NOTE(Emhyr): a stream is parsed as it's read, and each statement is dumped
+and then forgotten. it isn't analyzed, because that needs every statement.
+when only its syntax is checked, nothing's built, so nothing's dumped.
+*/
+static VOID stream_source(const CHAR *path, const struct OPTIONS *options, struct SESSION *session) {
+	struct STREAM *stream = &session->stream;
+	U64 fingerprint = 0;
+	begin_stream(path, stream);
+	for (BOOLEAN is_reading = 1; is_reading;) {
+		is_reading = read_stream(stream);
+		COUNT statements_count = resume_scanning(&stream->scanner, &stream->source, &session->buffer);
+		if (!is_reading) statements_count += finish_scanning(&stream->scanner, &stream->source, &session->buffer);
+
+		struct STATEMENT *statements = session->buffer.data;
+		COUNT next_statement = 0;
+		session->parser.source = &stream->source;
+		session->parser.statements = statements;
+		session->parser.statements_count = statements_count;
+		session->parser.next_statement = &next_statement;
+		session->parser.is_validating = options->is_validating;
+		(VOID)parse_statements(&session->parser);
+		session->parser.is_validating = 0;
+		if (options->is_fingerprinting) fingerprint = fingerprint_statements(fingerprint, &stream->source, statements, statements_count);
+		for (COUNT i = 0; i < statements_count && !options->is_validating; ++i) {
+			dump(&stream->source, statements[i].nodes, statements[i].nodes_count);
+			puts("--------------------------\n");
+		}
+
+		session->buffer.data_size = 0;
+		session->parser.buffer.data_size = 0;
+		slide_stream(stream);
+	}
+	if (options->is_fingerprinting) report(SEVERITY_comment, 0, 0, "fingerprint of %s: %016llx", path, fingerprint);
+	end_stream(stream);
+}
+
+#define MAXIMUM_ARGUMENTS_COUNT 32
+
+/* returns 0 if the request failed */
+static BOOLEAN serve_request(CHAR *line, struct SESSION *session) {
+	if (__builtin_setjmp(recovery_point)) return 0;
+
+	/* the request is the arguments of a one-off compilation, which are split by whitespace */
+	char *arguments[MAXIMUM_ARGUMENTS_COUNT + 1] = { "" };
+	int arguments_count = 1;
+	for (CHAR *c = line; *c;) {
+		if (*c == ' ' || *c == '\t' || *c == '\r') {
+			*c++ = 0;
+			continue;
+		}
+		if (arguments_count > MAXIMUM_ARGUMENTS_COUNT) fail(0, 0, "a request can't have more than %u arguments", MAXIMUM_ARGUMENTS_COUNT);
+		arguments[arguments_count++] = c;
+		while (*c && *c != ' ' && *c != '\t' && *c != '\r') ++c;
+	}
+
+	struct OPTIONS options;
+	parse_options(arguments_count, arguments, &options);
+	if (options.is_serving) fail(0, 0, "the server is already serving");
+	if (options.baselines_path) fail(0, 0, "the front end is only gated by itself");
+	if (options.is_walking) fail(0, 0, "a directory is only walked by itself");
+	if (!options.paths_count) fail(0, 0, "a path must be given");
+	if (options.is_streaming) {
+		for (COUNT i = 0; i < options.paths_count; ++i) {
+			if (!compare_strings(options.paths[i], "-")) fail(0, 0, "the standard input is the server's");
+			stream_source(options.paths[i], &options, session);
+			if (options.is_reporting_memory) report_memory(options.paths[i], session, 0, 0);
+		}
+		return 1;
+	}
+	begin_loading_sources(options.paths, options.paths_count, &session->loader);
+	for (COUNT i = 0; i < options.paths_count; ++i) {
+		struct SOURCE loaded_source = wait_for_source(i, &session->loader);
+		if (!loaded_source.data) fail(0, 0, "can't open %s", loaded_source.path);
+		const struct SOURCE *source;
+		COUNT statements_count;
+		struct STATEMENT *statements = parse_cached_source(loaded_source, &source, &statements_count, session);
+		if (!options.is_validating) compile_source(source, statements, statements_count, &options, session);
+		if (options.is_reporting_memory) report_memory(source->path, session, 0, 0);
+		reset_session(session);
+	}
+	end_loading_sources(&session->loader);
+	return 1;
+}
+
+/*
+NOTE(Emhyr): the server reads requests from the standard input, a line each,
+and writes its responses to the standard output, each ended by a line that
+says it was served. a socket is left to whatever's in front of the server.
+
+it's idle when it must wait for a request, so that's when it returns memory.
+*/
+static VOID serve(struct SESSION *session) {
+	enum { READ_SIZE = KIBIBYTES(64) };
+	HANDLE input = get_standard_input();
+	SIZE line_beginning = 0;
+	for (COUNT requests_count = 0;;) {
+		CHAR *data = session->input.data;
+		SIZE line_ending = line_beginning;
+		while (line_ending < session->input.data_size && data[line_ending] != '\n') ++line_ending;
+		if (line_ending == session->input.data_size) {
+			SIZE remaining_size = session->input.data_size - line_beginning;
+			if (remaining_size) move(data, data + line_beginning, remaining_size);
+			session->input.data_size = remaining_size;
+			line_beginning = 0;
+			trim_session(session);
+
+			SIZE read_size = read_from_file(push(READ_SIZE, 1, &session->input), READ_SIZE, input);
+			session->input.data_size -= READ_SIZE - read_size;
+			if (!read_size) break;
+			continue;
+		}
+		data[line_ending] = 0;
+		CHAR *line = data + line_beginning;
+		line_beginning = line_ending + 1;
+
+		BOOLEAN is_blank = 1;
+		for (CHAR *c = line; *c && is_blank; ++c) is_blank = *c == ' ' || *c == '\t' || *c == '\r';
+		if (is_blank) continue;
+
+		SIZE counter = query_performance_counter();
+		BOOLEAN is_served = serve_request(line, session);
+		if (session->loader.sources) end_loading_sources(&session->loader);
+		if (session->stream.source.data) end_stream(&session->stream);
+		reset_session(session);
+		report(SEVERITY_comment, 0, 0, "%s request %u in %.3f ms", is_served ? "served" : "failed", ++requests_count, get_elapsed_seconds(counter) * 1e3);
+		fflush(stdout);
+	}
+}
+
+/* scans and parses the source in parallel, compiles it, and releases it */
+static VOID compile_whole_source(struct SOURCE source, const struct OPTIONS *options, struct SESSION *session) {
+	COUNT statements_count = scan_statements(&source, &session->buffer);
+	struct STATEMENT *statements = session->buffer.data;
+	if (options->is_formatting) {
+		/* it's written at once, after what's been reported */
+		struct BUFFER text = DEFAULT_BUFFER;
+		format_source(&source, statements, statements_count, &text);
+		fflush(stdout);
+		(VOID)write_to_file(text.data, text.data_size, get_standard_output());
+		if (text.data) release_virtual_memory(text.data, text.reservation_size);
+		release_virtual_memory(source.data, source.size + sizeof(UTF32));
+		reset_session(session);
+		return;
+	}
+	COUNT parsers_count = query_processor_count();
+	if (parsers_count > statements_count) parsers_count = statements_count;
+	if (!parsers_count) parsers_count = 1;
+	struct WORKER *parsers = parse_source(&source, statements, statements_count, parsers_count, options->is_validating, &session->buffer);
+	if (!options->is_validating) compile_source(&source, statements, statements_count, options, session);
+	if (options->is_reporting_memory) report_memory(source.path, session, parsers, parsers_count);
+	for (COUNT i = 0; i < parsers_count; ++i)
+		if (parsers[i].buffer.data) release_virtual_memory(parsers[i].buffer.data, parsers[i].buffer.reservation_size);
+	release_virtual_memory(source.data, source.size + sizeof(UTF32));
+	reset_session(session);
+	trim_session(session);
+}
+
+int main(int argc, char *argv[]) {
+	struct OPTIONS options;
+	parse_options(argc, argv, &options);
+
+	if (options.baselines_path) {
+		run_gate(options.paths, options.paths_count, options.baselines_path, options.machine_baselines_path, options.is_recording_baselines, options.threshold);
+		return 0;
+	}
+
+	struct SESSION session;
+	begin_session(&session);
+	if (options.is_serving) {
+		is_recoverable = 1;
+		serve(&session);
+		return 0;
+	}
+
+	if (options.is_streaming) {
+		for (COUNT i = 0; i < options.paths_count; ++i) {
+			stream_source(options.paths[i], &options, &session);
+			if (options.is_reporting_memory) report_memory(options.paths[i], &session, 0, 0);
+		}
+		return 0;
+	}
+
+	/* the files are loaded ahead, and the directories are walked after them */
+	const CHAR *file_paths[MAXIMUM_PATHS_COUNT], *directory_paths[MAXIMUM_PATHS_COUNT];
+	COUNT file_paths_count = 0, directory_paths_count = 0;
+	for (COUNT i = 0; i < options.paths_count; ++i) {
+		U64 modification_time;
+		if (options.is_walking && query_file(options.paths[i], &modification_time) == FILE_KIND_directory) directory_paths[directory_paths_count++] = options.paths[i];
+		else file_paths[file_paths_count++] = options.paths[i];
+	}
+
+	struct LOADER loader;
+	begin_loading_sources(file_paths, file_paths_count, &loader);
+	for (COUNT i = 0; i < file_paths_count; ++i) {
+		struct SOURCE source = wait_for_source(i, &loader);
+		if (!source.data) fail(0, 0, "can't open %s", source.path);
+		compile_whole_source(source, &options, &session);
+	}
+	end_loading_sources(&loader);
+
+	if (!directory_paths_count) return 0;
+	struct LISTING listing = { 0 };
+	if (options.listing_path) load_listing(options.listing_path, &listing);
+	for (COUNT i = 0; i < directory_paths_count; ++i) {
+		/* only the last walk is saved, so that a listing's only of what was walked together */
+		struct FINDER finder;
+		begin_walking(directory_paths[i], options.extension, &listing, &finder);
+		for (COUNT j = 0;; ++j) {
+			const CHAR *path = wait_for_found_file(j, &finder);
+			if (!path) break;
+			struct SOURCE source = load_source(path);
+			if (!source.data) {
+				report(SEVERITY_caution, 0, 0, "can't open %s", path);
+				continue;
+			}
+			compile_whole_source(source, &options, &session);
+		}
+		end_walking(i + 1 == directory_paths_count ? options.listing_path : 0, &finder);
+	}
+	unload_listing(&listing);
 	return 0;
 }
 
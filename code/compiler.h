@@ -41,16 +41,80 @@ typedef B64 ADDRESS;
 
 typedef ADDRESS HANDLE;
 
-HANDLE open_file       (const CHAR *path);
+HANDLE open_file       (const CHAR *path); /* -1 if it can't be opened */
+HANDLE create_file     (const CHAR *path);
 SIZE   get_size_of_file(HANDLE file);
 SIZE   read_from_file  (VOID *buffer, SIZE size, HANDLE file);
+SIZE   write_to_file   (const VOID *buffer, SIZE size, HANDLE file);
 VOID   close_file      (HANDLE file);
 
+HANDLE get_standard_input (VOID);
+HANDLE get_standard_output(VOID);
+
+enum FILE_KIND {
+	FILE_KIND_none, /* there's nothing at the path */
+	FILE_KIND_regular,
+	FILE_KIND_directory,
+	FILE_KIND_other,
+};
+
+/* the modification time is in nanoseconds, from whenever the platform counts from */
+enum FILE_KIND query_file(const CHAR *path, U64 *modification_time);
+
+/*
+calls `visit` for each entry of a directory but `.` and `..`, or returns 0 if
+it can't be listed. a link to a directory is another kind, so that a walk never
+loops.
+*/
+typedef VOID DIRECTORY_VISITOR(const CHAR *name, enum FILE_KIND kind, VOID *parameter);
+BOOLEAN list_directory(const CHAR *path, DIRECTORY_VISITOR *visit, VOID *parameter);
+
+#if defined(__linux__)
+/*
+loads files asynchronously, or returns 0 if it can't. each file's data is
+followed by `padding_size` zeroes and belongs to whoever waits for it; it's 0
+if the file can't be loaded. the data is released with its size plus
+`padding_size`, even if the file shrank while it was loaded.
+
+only Linux has it; elsewhere, the compiler loads files with its own threads.
+*/
+HANDLE begin_loading_files(const CHAR *const *paths, SIZE count, SIZE padding_size);
+VOID  *wait_for_file      (HANDLE loader, SIZE index, SIZE *size);
+VOID   end_loading_files  (HANDLE loader);
+#endif
+
 SIZE query_system_page_size(VOID);
+SIZE query_processor_count (VOID);
+
+SIZE query_performance_counter  (VOID);
+SIZE query_performance_frequency(VOID);
+
+enum EVENT {
+	EVENT_instructions,
+	EVENT_cache_misses,
+};
+
+/*
+counts a hardware event on the calling thread, or returns -1 if it can't: on
+Linux, that's when the kernel doesn't allow it, and on Windows, it's always,
+since the counters need a driver there. only a counter that's opened is read or
+closed.
+*/
+HANDLE open_event_counter (enum EVENT event);
+U64    read_event_counter (HANDLE counter);
+VOID   close_event_counter(HANDLE counter);
 
 VOID *allocate_virtual_memory(SIZE size);
 VOID *reserve_virtual_memory (SIZE size);
 VOID  commit_virtual_memory  (VOID *memory, SIZE size);
+VOID  decommit_virtual_memory(VOID *memory, SIZE size);
+VOID  protect_virtual_memory (VOID *memory, SIZE size, BOOLEAN is_executable);
 VOID  release_virtual_memory (VOID *memory, SIZE size);
 
+typedef WORD THREAD_PROCEDURE(VOID *parameter);
+
+HANDLE create_thread(THREAD_PROCEDURE *procedure, VOID *parameter);
+VOID   join_thread  (HANDLE thread);
+VOID   yield_thread (VOID);
+
 #endif